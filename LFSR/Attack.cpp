@@ -0,0 +1,221 @@
+/*
+ * File: Attack.cpp
+ * Author: Arthur Laks
+ *
+ * This is a known-plaintext attack on the LFSR cipher.  It takes a plaintext file and the file
+ * that it was encrypted to, xors them to obtain the keystream, and uses the Berlekamp-Massey
+ * algorithm to find the shortest shift register that generates it.  The connection polynomial
+ * of that register is converted into a key in the layout that KeyStream::unpack expects, and
+ * optionally written to a key file that the driver can use.
+
+ */
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <iomanip>
+#include "KeyStream.h"
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::vector;
+using std::string;
+
+using LSFR::BasicKeyStream;
+
+typedef unsigned long int Word;
+const unsigned int WORD_BITS = sizeof(Word) * 8;
+
+//Xors the polynomial in the second argument, shifted up by shift terms, into the first argument.
+//Only the first source_words words of the source are nonzero.
+void xor_shifted(vector<Word>& destination,const vector<Word>& source,std::size_t source_words,
+		std::size_t shift){
+	std::size_t words = shift / WORD_BITS;
+	unsigned int bits = shift % WORD_BITS;
+	for(std::size_t word = 0;word < source_words;++word){
+		destination[word + words] ^= source[word] << bits;
+		//Shifting a word by its whole length is undefined, so skip the carry if bits is 0.
+		if(bits){
+			destination[word + words + 1] ^= source[word] >> (WORD_BITS - bits);
+		}
+	}
+}
+
+//Finds the shortest linear recurrence s[n] = c[1]s[n - 1] + ... + c[L]s[n - L] that generates
+//the sequence, using the Berlekamp-Massey algorithm.  The first argument holds the bits of the
+//sequence in reverse order, so that bit j is s[length - 1 - j].  Returns L, and assigns the
+//connection polynomial 1 + c[1]x + ... + c[L]x^L to the last argument, where bit i is c[i].
+//
+//The polynomials and the sequence are packed into words, so the discrepancy at each step is the
+//parity of the and of the connection polynomial with a window of the reversed sequence, and
+//both it and the update of the polynomial only touch the words up to its degree.
+std::size_t berlekamp_massey(const vector<Word>& reversed,std::size_t length,vector<Word>& connection){
+	std::size_t num_words = length / WORD_BITS + 3;
+	connection.assign(num_words,0);
+	vector<Word> previous(num_words,0);	//The connection polynomial before the last length change.
+	connection[0] = previous[0] = 1;
+
+	std::size_t complexity = 0;		//L, the length of the current recurrence.
+	std::size_t previous_complexity = 0;
+	std::size_t shift = 1;		//The number of steps since the last length change.
+	for(std::size_t n = 0;n < length;++n){
+		//The discrepancy is s[n] + c[1]s[n - 1] + ... + c[L]s[n - L].  s[n - i] is bit
+		//length - 1 - n + i of reversed, so the window starts at bit offset.
+		std::size_t offset = length - 1 - n;
+		std::size_t first_word = offset / WORD_BITS;
+		unsigned int bits = offset % WORD_BITS;
+		Word combined = 0;
+		//Bits past the beginning of the sequence are 0.
+		for(std::size_t word = 0;word <= complexity / WORD_BITS && first_word + word < reversed.size();++word){
+			Word window = reversed[first_word + word] >> bits;
+			if(bits && first_word + word + 1 < reversed.size()){
+				window |= reversed[first_word + word + 1] << (WORD_BITS - bits);
+			}
+			combined ^= connection[word] & window;
+		}
+		if(!LSFR::Register<WORD_BITS>::parity(combined)){
+			++shift;
+			continue;
+		}
+		//Cancel the discrepancy by adding x^shift times the previous polynomial.  If the
+		//recurrence is too short to have generated the sequence so far, it has to get longer.
+		if(2 * complexity <= n){
+			vector<Word> temporary(connection.begin(),connection.begin() + complexity / WORD_BITS + 1);
+			xor_shifted(connection,previous,previous_complexity / WORD_BITS + 1,shift);
+			previous_complexity = complexity;
+			complexity = n + 1 - complexity;
+			std::fill(previous.begin(),previous.end(),0);
+			std::copy(temporary.begin(),temporary.end(),previous.begin());
+			shift = 1;
+		}else{
+			xor_shifted(connection,previous,previous_complexity / WORD_BITS + 1,shift);
+			++shift;
+		}
+	}
+	return complexity;
+}
+
+//Recovers the key of a register of the specified length from the keystream, and checks it.
+template<unsigned int Length>
+int run(const vector<char>& plaintext,const vector<char>& ciphertext,const char* key_filename){
+	typedef BasicKeyStream<Length> KeyStream;
+	typedef typename KeyStream::Bit_Sequence Bit_Sequence;
+	const std::size_t IV_SIZE = sizeof(Bit_Sequence);
+
+	if(ciphertext.size() < IV_SIZE){
+		cerr << "The ciphertext is too short to contain an iv." << endl;
+		return 2;
+	}
+	//The ciphertext starts with the iv, which is the initial contents of the register.
+	Bit_Sequence iv;
+	std::copy(ciphertext.begin(),ciphertext.begin() + IV_SIZE,reinterpret_cast<char*>(&iv));
+	std::size_t num_bytes = std::min(plaintext.size(),ciphertext.size() - IV_SIZE);
+	std::size_t length = num_bytes * 8;
+
+	//Bit b of byte i of the keystream is bit 8i + b of the sequence.  Store the sequence in
+	//reverse order.
+	vector<Word> reversed(length / WORD_BITS + 1,0);
+	for(std::size_t bit = 0;bit < length;++bit){
+		char key_byte = plaintext[bit / 8] ^ ciphertext[IV_SIZE + bit / 8];
+		Word value = (key_byte >> (bit % 8)) & 1;
+		std::size_t position = length - 1 - bit;
+		reversed[position / WORD_BITS] |= value << (position % WORD_BITS);
+	}
+
+	vector<Word> connection;
+	std::size_t complexity = berlekamp_massey(reversed,length,connection);
+	cout << "Bits of keystream analyzed: " << length << endl;
+	cout << "Linear complexity: " << complexity << endl;
+	cout << "Connection polynomial: 1";
+	for(std::size_t i = 1;i <= complexity;++i){
+		if((connection[i / WORD_BITS] >> (i % WORD_BITS)) & 1){
+			cout << " + x^" << i;
+		}
+	}
+	cout << endl;
+	if(length < 2 * Length){
+		cout << "Warning: at least " << 2 * Length << " bits are needed to determine a register of "
+				<< Length << " bits uniquely." << endl;
+	}
+	if(complexity > Length){
+		cerr << "The keystream was not generated by a register of " << Length << " bits." << endl;
+		return 3;
+	}
+
+	//The new bit of the register is s[t + Length] = c[1]s[t + Length - 1] + ... and the register
+	//holds s[t] through s[t + Length - 1] at indices 0 through Length - 1, so the tap at index
+	//Length - i is c[i].
+	vector<typename KeyStream::Bit> taps(Length,0);
+	for(std::size_t i = 1;i <= complexity;++i){
+		taps[Length - i] = (connection[i / WORD_BITS] >> (i % WORD_BITS)) & 1;
+	}
+	Bit_Sequence key = KeyStream::pack(taps.begin());
+
+	cout << "Recovered key: 0x";
+	const Word* key_words = reinterpret_cast<const Word*>(&key);
+	for(int word = IV_SIZE / sizeof(Word) - 1;word >= 0;--word){
+		cout << std::hex << std::setw(sizeof(Word) * 2) << std::setfill('0') << key_words[word];
+	}
+	cout << std::dec << endl << "Taps:";
+	for(unsigned int i = 0;i < Length;++i){
+		if(taps[i]){
+			cout << " " << i;
+		}
+	}
+	cout << endl;
+
+	//Regenerate the keystream with the recovered key, and make sure it matches.
+	vector<char> regenerated(num_bytes);
+	KeyStream key_stream(iv,key);
+	key_stream.fill(regenerated.data(),num_bytes);
+	for(std::size_t i = 0;i < num_bytes;++i){
+		if((regenerated[i] ^ ciphertext[IV_SIZE + i]) != plaintext[i]){
+			cerr << "The recovered key does not reproduce byte " << i << " of the keystream." << endl;
+			return 3;
+		}
+	}
+	cout << "The recovered key reproduces all of the keystream." << endl;
+
+	if(key_filename){
+		std::ofstream key_file(key_filename,std::ios::binary|std::ios::out);
+		key_file.write(reinterpret_cast<const char*>(&key),sizeof(key));
+	}
+	return 0;
+}
+
+int main(int argc,char* argv[]){
+	if(argc < 3){
+		cerr << "Usage: Attack plaintext_file ciphertext_file [key_output_file [register_length]]" << endl;
+		return 1;
+	}
+	std::ifstream plaintext_file(argv[1],std::ios::binary|std::ios::in);
+	std::ifstream ciphertext_file(argv[2],std::ios::binary|std::ios::in);
+	if(!plaintext_file || !ciphertext_file){
+		cerr << "File does not exist." << endl;
+		return 2;
+	}
+	//The inner parentheses are to avoid the C++ most vexing parse.
+	vector<char> plaintext(std::istreambuf_iterator<char>(plaintext_file),(std::istreambuf_iterator<char>()));
+	vector<char> ciphertext(std::istreambuf_iterator<char>(ciphertext_file),(std::istreambuf_iterator<char>()));
+	const char* key_filename = argc > 3 ? argv[3] : nullptr;
+
+	unsigned int register_length = argc > 4 ? std::atoi(argv[4]) : 64;
+	switch(register_length){
+	case 64:
+		return run<64>(plaintext,ciphertext,key_filename);
+	case 128:
+		return run<128>(plaintext,ciphertext,key_filename);
+	case 256:
+		return run<256>(plaintext,ciphertext,key_filename);
+	case 512:
+		return run<512>(plaintext,ciphertext,key_filename);
+	case 1024:
+		return run<1024>(plaintext,ciphertext,key_filename);
+	default:
+		cerr << "The register length must be 64, 128, 256, 512 or 1024." << endl;
+		return 1;
+	}
+}
@@ -0,0 +1,92 @@
+/*
+ * File: BatchKeyStream.cpp
+ * Author: Arthur Laks
+
+ Contains the definitions of the methods of the BatchKeyStream class.
+
+ */
+
+#include "BatchKeyStream.h"
+
+namespace LSFR {
+
+	BatchKeyStream::BatchKeyStream(const Bit_Sequence ivs[],const Bit_Sequence keys[],unsigned int count):
+			count(count){
+		//Registers that are not used are left all zero.  Transposing the array of registers
+		//turns it into an array of slices.
+		std::fill(slices,slices + REGISTER_LENGTH,0);
+		std::fill(key_slices,key_slices + REGISTER_LENGTH,0);
+		std::copy(ivs,ivs + count,slices);
+		std::copy(keys,keys + count,key_slices);
+		transpose(slices);
+		transpose(key_slices);
+	}
+
+	//The bits that are tapped from the front of each register during the next REGISTER_LENGTH
+	//steps are the bits that are in it now, so the stream is the transpose of the slices.  The
+	//new slices are generated after them, one step at a time.  Together they form a window of
+	//2 * REGISTER_LENGTH slices, where the new slice at the back of the register after step i
+	//is the xor of the slices i + j for which bit j of the key is 1.
+	void BatchKeyStream::next_words(Bit_Sequence words[]){
+		Bit_Sequence window[REGISTER_LENGTH * 2];
+		std::copy(slices,slices + REGISTER_LENGTH,window);
+		for(unsigned int step = 0;step < REGISTER_LENGTH;++step){
+			//Every register has its own key, so the key is anded with each slice instead of
+			//deciding which slices to xor.  This loop has no branches, so the compiler can
+			//vectorize it.
+			Bit_Sequence new_slice = 0;
+			for(unsigned int tap = 0;tap < REGISTER_LENGTH;++tap){
+				new_slice ^= window[step + tap] & key_slices[tap];
+			}
+			window[REGISTER_LENGTH + step] = new_slice;
+		}
+		std::copy(slices,slices + REGISTER_LENGTH,words);
+		transpose(words);
+		std::copy(window + REGISTER_LENGTH,window + REGISTER_LENGTH * 2,slices);
+	}
+
+	void BatchKeyStream::xor_into(char* const buffers[],const std::size_t lengths[]){
+		//There is nothing to do, and no length to take the maximum of, without registers.
+		if(count == 0){
+			return;
+		}
+		std::size_t longest = *std::max_element(lengths,lengths + count);
+		Bit_Sequence words[LANES];
+		//Generate a word of every stream at a time, and xor each buffer that did not end yet
+		//with its word.  The first byte of the stream is the least significant byte of the word.
+		for(std::size_t position = 0;position < longest;position += sizeof(Bit_Sequence)){
+			next_words(words);
+			for(unsigned int lane = 0;lane < count;++lane){
+				std::size_t end = std::min(lengths[lane],position + sizeof(Bit_Sequence));
+				for(std::size_t byte = position;byte < end;++byte){
+					buffers[lane][byte] ^= static_cast<char>(words[lane] >> ((byte - position) * 8));
+				}
+			}
+		}
+	}
+
+	void BatchKeyStream::xor_records(std::size_t count,const Bit_Sequence ivs[],const Bit_Sequence keys[],
+			char* const buffers[],const std::size_t lengths[]){
+		for(std::size_t first = 0;first < count;first += LANES){
+			unsigned int batch_size = std::min<std::size_t>(LANES,count - first);
+			BatchKeyStream batch(ivs + first,keys + first,batch_size);
+			batch.xor_into(buffers + first,lengths + first);
+		}
+	}
+
+	//Uses the recursive algorithm from Hacker's Delight: the matrix is divided into four
+	//quadrants, the top right and bottom left quadrants are swapped, and then the same is done
+	//to each quadrant, all of them at once, with masks selecting which bits to swap.
+	void BatchKeyStream::transpose(Bit_Sequence matrix[]){
+		Bit_Sequence mask = ~static_cast<Bit_Sequence>(0) >> (REGISTER_LENGTH / 2);
+		for(unsigned int width = REGISTER_LENGTH / 2;width != 0;width >>= 1,mask ^= mask << width){
+			//Visit every row k whose bit of value width is 0, and swap with row k + width.
+			for(unsigned int row = 0;row < REGISTER_LENGTH;row = ((row | width) + 1) & ~width){
+				Bit_Sequence difference = ((matrix[row] >> width) ^ matrix[row | width]) & mask;
+				matrix[row | width] ^= difference;
+				matrix[row] ^= difference << width;
+			}
+		}
+	}
+
+} /* namespace LSFR */
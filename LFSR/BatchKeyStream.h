@@ -0,0 +1,57 @@
+/*
+ * File: BatchKeyStream.h
+ * Author: Arthur Laks
+
+ * This file contains the definition of the BatchKeyStream class, which runs many shift
+ * registers with different ivs and keys side by side.
+
+ */
+
+#include <cstddef>
+#include "KeyStream.h"
+#ifndef BATCHKEYSTREAM_H_
+#define BATCHKEYSTREAM_H_
+
+namespace LSFR {
+//The registers are bitsliced: instead of storing each register in its own word, word i stores
+//bit i of every register, one register per bit of the word.  That way a single and and xor of
+//two words operate on all of the registers at once, and all of the registers can have
+//different keys.  Every register produces the same stream as a KeyStream with the same iv and
+//key.
+class BatchKeyStream {
+public:
+	typedef KeyStream::Bit_Sequence Bit_Sequence;
+	static const unsigned int REGISTER_LENGTH = KeyStream::REGISTER_LENGTH;
+	//The number of registers that run side by side, one in each bit of a word.
+	static const unsigned int LANES = sizeof(Bit_Sequence) * 8;
+
+	//Constructs count registers, where count is at most LANES, with the corresponding ivs and
+	//keys.
+	BatchKeyStream(const Bit_Sequence ivs[],const Bit_Sequence keys[],unsigned int count);
+
+	//Xors the keystream of register i into buffers[i], which has lengths[i] bytes, for each of
+	//the registers.  The buffers are not required to have the same length.
+	void xor_into(char* const buffers[],const std::size_t lengths[]);
+
+	//Xors each of the count records with the keystream for its own iv and key, LANES records at
+	//a time.
+	static void xor_records(std::size_t count,const Bit_Sequence ivs[],const Bit_Sequence keys[],
+			char* const buffers[],const std::size_t lengths[]);
+
+	//Transposes a square matrix of bits, where each word is a row.  Bit j of row i is swapped
+	//with bit i of row j.
+	static void transpose(Bit_Sequence matrix[]);
+private:
+	//Assigns the next REGISTER_LENGTH bits of the stream of each register to the
+	//corresponding element of the argument, and advances the registers past them.
+	void next_words(Bit_Sequence words[]);
+
+	unsigned int count;
+	//Bit j of slices[i] is bit i of register j.
+	Bit_Sequence slices[REGISTER_LENGTH];
+	//Bit j of key_slices[i] is bit i of the key of register j.
+	Bit_Sequence key_slices[REGISTER_LENGTH];
+};
+
+} /* namespace LSFR */
+#endif /* BATCHKEYSTREAM_H_ */
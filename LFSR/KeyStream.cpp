@@ -2,46 +2,198 @@
  * File: KeyStream.cpp
  * Author: Arthur Laks
 
- Contians the definitions of the non-templated methods fo the KeyStream class.
+ Contains the definitions of the template members of BasicKeyStream<Length>, and explicitly
+ instantiates the class for the supported register lengths: 64, 128, 256, 512 and 1024 bits.
 
  */
 
 #include "KeyStream.h"
-#include <numeric>	//For inner_product
-#include <iterator>
 
 namespace LSFR {
 
 	//Extracts a byte-worth of keystream.
-	KeyStream& KeyStream::operator>>(char& result){
-	  std::vector<Bit> unpacked(8);	//Store the result as a vector of bits before packing them
-		//into a byte and assigning result to it.
-		//For each bit of keystream to be generated
-
-		//Uses the formula in the textbook on page 24.
-		//For every bit to generate
-		for(unsigned int counter = 0;counter < sizeof(char) * 8;++counter){
-			unpacked[counter] = shift_register.front();	//Tap the bit in the front of the
-			//register at the next bit in the stream.
-
-			//The value of the new bit at the back of the register should be the xor of a
-			//subset of the bits in the register.  That subset is the at the indices i for which
-			//key[i] = 1.  This is implemented with the inner_product algorithm.
-			shift_register.push_back(std::inner_product(key.begin(),key.end(),shift_register.begin(),0) % 2);
-			shift_register.pop_front();
-		}
-		//Pack the vector of bits into a single byte.
-		result = pack(unpacked.begin());
+	template<unsigned int Length>
+	BasicKeyStream<Length>& BasicKeyStream<Length>::operator>>(char& result){
+		//The register is clocked a full word at a time, so the buffer is only refilled when
+		//there is less than a byte left in it.  The first bit of the stream is the least
+		//significant bit of the byte.
+		if(buffered_bits >= 8){
+			result = static_cast<char>(Register::byte(buffered,0));
+			buffered = Register::shift_right(buffered,8);
+			buffered_bits -= 8;
+		}else{
+			//Take the bits that are left, and fill the rest of the byte from the next word.
+			Bit_Sequence next = next_word();
+			unsigned int missing = 8 - buffered_bits;
+			result = static_cast<char>(Register::byte(
+					Register::bitwise_or(buffered,Register::shift_left(next,buffered_bits)),0));
+			buffered = Register::shift_right(next,missing);
+			buffered_bits = Length - missing;
+		}
 		return *this;
 	}
+
+	template<unsigned int Length>
+	void BasicKeyStream<Length>::fill(char* buffer,std::size_t length){
+		std::size_t counter = 0;
+		//Copy a word of keystream at a time.  The first byte of the stream is the least
+		//significant byte of the word.
+		for(;counter + sizeof(Bit_Sequence) <= length;counter += sizeof(Bit_Sequence)){
+			Bit_Sequence word = take_word();
+			for(unsigned int byte = 0;byte < sizeof(Bit_Sequence);++byte){
+				buffer[counter + byte] = static_cast<char>(Register::byte(word,byte));
+			}
+		}
+		//Extract the bytes at the end that do not make up a whole word one at a time.
+		for(;counter < length;++counter){
+			*this >> buffer[counter];
+		}
+	}
+
+	template<unsigned int Length>
+	void BasicKeyStream<Length>::xor_into(char* buffer,std::size_t length){
+		std::size_t counter = 0;
+		for(;counter + sizeof(Bit_Sequence) <= length;counter += sizeof(Bit_Sequence)){
+			Bit_Sequence word = take_word();
+			for(unsigned int byte = 0;byte < sizeof(Bit_Sequence);++byte){
+				buffer[counter + byte] ^= static_cast<char>(Register::byte(word,byte));
+			}
+		}
+		for(;counter < length;++counter){
+			char current_key;
+			*this >> current_key;
+			buffer[counter] ^= current_key;
+		}
+	}
+
+	//The buffered bits come first, followed by the beginning of the next word.  The rest of the
+	//next word becomes the buffer, so the number of buffered bits does not change.
+	template<unsigned int Length>
+	typename BasicKeyStream<Length>::Bit_Sequence BasicKeyStream<Length>::take_word(){
+		Bit_Sequence next = next_word();
+		if(buffered_bits == 0){
+			return next;
+		}
+		Bit_Sequence retval = Register::bitwise_or(buffered,Register::shift_left(next,buffered_bits));
+		buffered = Register::shift_right(next,Length - buffered_bits);
+		return retval;
+	}
+
+	//Uses the formula in the textbook on page 24.  The bits that are tapped from the front of
+	//the register during the next REGISTER_LENGTH steps are exactly the bits that are in the
+	//register now, so they are returned as they are.
+	template<unsigned int Length>
+	typename BasicKeyStream<Length>::Bit_Sequence BasicKeyStream<Length>::next_word(){
+		Bit_Sequence retval = shift_register;
+		shift_register = advance(shift_register);
+		return retval;
+	}
+
+	//Each bit of the register after REGISTER_LENGTH steps is the xor of a fixed subset of the
+	//current register, which was precomputed in the constructor, so all of them can be computed
+	//independently instead of one after another.
+	template<unsigned int Length>
+	typename BasicKeyStream<Length>::Bit_Sequence BasicKeyStream<Length>::advance(const Bit_Sequence& current) const{
+		Bit_Sequence next_register = Register::from_word(0);
+		for(unsigned int counter = 0;counter < Length;++counter){
+			Register::set_bit(next_register,counter,Register::parity_of_and(feedback[counter],current));
+		}
+		return next_register;
+	}
+
+	//Multiplies the polynomial by x.  The term that overflows is x^Length, which is congruent to
+	//the key.
+	template<unsigned int Length>
+	typename BasicKeyStream<Length>::Bit_Sequence BasicKeyStream<Length>::times_x(const Bit_Sequence& polynomial) const{
+		return Register::bitwise_xor(Register::shift_left(polynomial,1),
+				Register::select(key,Register::bit(polynomial,Length - 1)));
+	}
+
+	//Multiplies two polynomials using Horner's rule, starting from the highest coefficient of
+	//the second one.
+	template<unsigned int Length>
+	typename BasicKeyStream<Length>::Bit_Sequence BasicKeyStream<Length>::multiply(const Bit_Sequence& a,const Bit_Sequence& b) const{
+		Bit_Sequence result = Register::from_word(0);
+		for(int bit = Length - 1;bit >= 0;--bit){
+			result = Register::bitwise_xor(times_x(result),Register::select(a,Register::bit(b,bit)));
+		}
+		return result;
+	}
+
+	//Calculates x^n using repeated squaring.
+	template<unsigned int Length>
+	typename BasicKeyStream<Length>::Bit_Sequence BasicKeyStream<Length>::power_of_x(Offset n) const{
+		Bit_Sequence result = Register::from_word(1);
+		for(int bit = sizeof(n) * 8 - 1;bit >= 0;--bit){
+			result = multiply(result,result);
+			if((n >> bit) & 1){
+				result = times_x(result);
+			}
+		}
+		return result;
+	}
+
+	template<unsigned int Length>
+	void BasicKeyStream<Length>::skip(Offset n_bits){
+		//If the bits are all in the buffer then just discard them.
+		if(n_bits < buffered_bits){
+			buffered = Register::shift_right(buffered,n_bits);
+			buffered_bits -= n_bits;
+			return;
+		}
+		//Otherwise the register holds the stream starting right after the buffer.
+		n_bits -= buffered_bits;
+		buffered = Register::from_word(0);
+		buffered_bits = 0;
+
+		//Every bit of the stream satisfies the recurrence whose characteristic polynomial is
+		//P(x) = x^Length + key, so if x^n = r(x) mod P(x), then the stream n bits ahead is the
+		//xor of the stream i bits ahead for every term x^i of r(x).  Those are windows of the
+		//current register followed by the register Length steps later.
+		Bit_Sequence coefficients = power_of_x(n_bits);
+		Bit_Sequence next_register = advance(shift_register);
+		Bit_Sequence result = Register::from_word(0);
+		for(unsigned int i = 0;i < Length;++i){
+			if(Register::bit(coefficients,i)){
+				result = Register::bitwise_xor(result,i ? Register::bitwise_or(Register::shift_right(shift_register,i),
+						Register::shift_left(next_register,Length - i)) : shift_register);
+			}
+		}
+		shift_register = result;
+	}
+
+	template<unsigned int Length>
+	void BasicKeyStream<Length>::seek(Offset offset){
+		//Rewind to the initialization vector and jump ahead from there.
+		shift_register = iv;
+		buffered = Register::from_word(0);
+		buffered_bits = 0;
+		skip(offset * 8);
+	}
+
 	//Construct a KeyStream with the specified initialization vector and key.
-	KeyStream::KeyStream(Bit_Sequence iv,Bit_Sequence key):
-			shift_register(sizeof(Bit_Sequence) * 8),
-			key(sizeof(Bit_Sequence) * 8){
-		//Initialize the shift register to the iv.
-		unpack(iv,shift_register.begin());
-		unpack(key,this->key.begin());
+	template<unsigned int Length>
+	BasicKeyStream<Length>::BasicKeyStream(const Bit_Sequence& iv,const Bit_Sequence& key):
+			shift_register(iv),iv(iv),key(key),buffered(Register::from_word(0)),buffered_bits(0){
+		//The new bit at the back of the register is the xor of the bits at the indices i for
+		//which key[i] = 1.  Bit n of the next register is generated n steps after that, when
+		//the register has been shifted n times.  The bits of the window that are still part of
+		//the current register are at key << n, and every bit that was generated since then is
+		//replaced with the row that generated it.
+		for(unsigned int row = 0;row < Length;++row){
+			feedback[row] = Register::shift_left(key,row);
+			for(unsigned int tap = Length - row;tap < Length;++tap){
+				if(Register::bit(key,tap)){
+					feedback[row] = Register::bitwise_xor(feedback[row],feedback[tap + row - Length]);
+				}
+			}
+		}
 	}
 
+	template class BasicKeyStream<64>;
+	template class BasicKeyStream<128>;
+	template class BasicKeyStream<256>;
+	template class BasicKeyStream<512>;
+	template class BasicKeyStream<1024>;
 
 } /* namespace LSFR */
@@ -2,64 +2,115 @@
  * File: KeyStream.h
  * Author: Arthur Laks
 
- * This file contains the definition of the KeyStream class and the implementation of its
- * templated methods.
+ * This file contains the definition of the BasicKeyStream class template and the
+ * implementation of its templated methods.  The rest of its methods are defined in
+ * KeyStream.cpp, which instantiates it for the supported register lengths.
 
  */
 
-#include <deque>
 #include <vector>
 #include <iostream>
 #include <bitset>
 #include <sstream>
 #include <algorithm>
+#include <cstddef>
+#include "Register.h"
 #ifndef KEYSTREAM_H_
 #define KEYSTREAM_H_
 
 namespace LSFR {
-class KeyStream {
+//Length is the number of bits in the shift register.  It must be one of the lengths that are
+//instantiated in KeyStream.cpp.
+template<unsigned int Length>
+class BasicKeyStream {
+	typedef LSFR::Register<Length> Register;
 public:
 	//This type represents a single bit.  The only values it should store are 0 and 1.
 	typedef char Bit;
 	//This is the type of the iv and the key.
-	typedef unsigned long int Bit_Sequence;
+	typedef typename Register::Type Bit_Sequence;
+	//The type of positions within the keystream, in bits or bytes.
+	typedef unsigned long long Offset;
+	//The number of bits in the shift register.
+	static const unsigned int REGISTER_LENGTH = Length;
 
-	KeyStream(Bit_Sequence iv,Bit_Sequence key);
+	BasicKeyStream(const Bit_Sequence& iv,const Bit_Sequence& key);
 	//Extracts a byte-worth of stream.
-	KeyStream & operator >>(char&);
+	BasicKeyStream & operator >>(char&);
+	//Fills the buffer with the next length bytes of keystream.
+	void fill(char* buffer,std::size_t length);
+	//Xors the next length bytes of keystream into the buffer.
+	void xor_into(char* buffer,std::size_t length);
+
+	//Discards the next n bits of keystream.  The register is jumped ahead directly, so this
+	//takes time proportional to the logarithm of n.
+	void skip(Offset n_bits);
+	//Positions the stream so that the next byte extracted is the byte at the specified offset
+	//from the beginning of the keystream.
+	void seek(Offset offset);
 
 	//Turns a numeric value into a container of bits.
 	template<typename Iterator>
-	static void unpack(Bit_Sequence packed,Iterator start){
-		for(unsigned int counter = 0;counter < sizeof(Bit_Sequence) * 8;++counter){
-			//1 << counter is the bitmask.  It is anded with packed, which masks out all of the
-			//other bits.  The result is shifted back by counter, so that the resulting char will
-			//be either 0 or 1.
-
-			//Cast 1 to an unsigned int in order to force the gcc to treat the shift as a
-			//logical shift and not an arithmetic shift.
-			*start++ = (((static_cast<Bit_Sequence>(1) << counter) & packed) >> counter);
-
+	static void unpack(const Bit_Sequence& packed,Iterator start){
+		for(unsigned int counter = 0;counter < Length;++counter){
+			//Register::bit masks out all of the other bits and shifts the result back, so that
+			//the resulting char will be either 0 or 1.
+			*start++ = Register::bit(packed,counter);
 		}
 	}
 
 	//Converts a container of bits into a numeric value
 	template<typename Iterator>
 	static Bit_Sequence pack(Iterator begin){
-		Bit_Sequence retval = 0;
-		for(unsigned long counter = 0;counter < sizeof(Bit_Sequence) * 8;++counter){
-			//Set the nth bit of retval to the nth element in the container, shifted n to the
-			//left, so that it would be either 0 or 1.
-			retval |= *(begin + counter) << counter;
+		Bit_Sequence retval = Register::from_word(0);
+		for(unsigned long counter = 0;counter < Length;++counter){
+			//Set the nth bit of retval if the nth element in the container is 1.
+			if(*(begin + counter)){
+				Register::set_bit(retval,counter);
+			}
 		}
 		return retval;
 	}
 private:
-	//The shift register is a deque in order to allow bits to be added to one end and removed
-	//from the other.
-	std::deque<Bit> shift_register;
-	std::vector<Bit> key;
+	//Returns the next REGISTER_LENGTH bits of keystream and advances the register past them.
+	Bit_Sequence next_word();
+	//Returns the next REGISTER_LENGTH bits of keystream, starting with the buffered bits.
+	Bit_Sequence take_word();
+	//Returns the contents of the register REGISTER_LENGTH steps after it contained the argument.
+	Bit_Sequence advance(const Bit_Sequence&) const;
+
+	//Polynomials over GF(2) of degree less than Length are stored in a Bit_Sequence, where bit
+	//i is the coefficient of x^i.  All arithmetic is done modulo the characteristic polynomial
+	//of the register, x^Length + key, whose leading term is implicit.
+	Bit_Sequence times_x(const Bit_Sequence&) const;
+	Bit_Sequence multiply(const Bit_Sequence&,const Bit_Sequence&) const;
+	Bit_Sequence power_of_x(Offset) const;
+
+	//The shift register is packed into a Bit_Sequence.  Bit i is the bit at index i of the
+	//register, so the front of the register is the least significant bit.
+	Bit_Sequence shift_register;
+	//The initialization vector and the key are kept in order to be able to seek.
+	Bit_Sequence iv;
+	Bit_Sequence key;
+	//Row i is the subset of the current register whose xor is the ith bit of the register
+	//REGISTER_LENGTH steps from now.  The first row is the key itself.
+	Bit_Sequence feedback[Length];
+
+	//Keystream that was generated by next_word but was not extracted yet, and the number of
+	//bits of it that are left.
+	Bit_Sequence buffered;
+	unsigned int buffered_bits;
 };
 
+//The register lengths that are instantiated in KeyStream.cpp.
+extern template class BasicKeyStream<64>;
+extern template class BasicKeyStream<128>;
+extern template class BasicKeyStream<256>;
+extern template class BasicKeyStream<512>;
+extern template class BasicKeyStream<1024>;
+
+//The original register is a single word.
+typedef BasicKeyStream<sizeof(unsigned long int) * 8> KeyStream;
+
 } /* namespace LSFR */
 #endif /* KEYSTREAM_H_ */
@@ -5,6 +5,13 @@
  * This is the driver of the LFSR program.  It asks the user for an input file and a file with
  * the key, and encrypts or decrypts the file based on the key.  In encryption mode, the
  * initialization vector is generated randomly and inserted at the beginning of the output file.
+ * The optional command line argument is the number of threads to use.  In that case the input
+ * is divided into chunks, and each thread xors its chunk with the keystream starting at the
+ * chunk's offset.
+ * The second optional argument is the length of the shift register in bits, which must be 64,
+ * 128, 256, 512 or 1024.  The key file and the iv have the same number of bits.
+ * Regular files are memory-mapped and transformed in place in the mapping of the output file.
+ * Other files, such as pipes, are read and written through streams in large blocks.
 
  */
 
@@ -15,7 +22,10 @@
 #include <iterator>
 #include <ctime>
 #include <cstdlib>
+#include <thread>
+#include <algorithm>
 #include "KeyStream.h"
+#include "MappedFile.h"
 using std::cout;
 using std::cin;
 using std::endl;
@@ -23,59 +33,197 @@ using std::vector;
 using std::hex;
 using std::string;
 
-using LSFR::KeyStream;
-int main(){
-	string input_filename,key_filename,output_filename;
-	cout << "Enter the name of the input file: ";
-	cin >> input_filename;
-	cout << "Enter the name of the output file: ";
-	cin >> output_filename;
-	cout << "Enter the name of the file with the key (a binary file with 64 bits): ";
-	cin >> key_filename;
+using LSFR::BasicKeyStream;
+using LSFR::MappedFile;
+
+//The number of bytes of the input that are read and transformed at a time.  In parallel mode
+//each thread transforms a chunk of this size.
+const std::size_t CHUNK_SIZE = 1 << 20;
+//The largest number of threads that are used for each core.
+const long MAX_THREADS_PER_CORE = 4;
+
+//Reads the input in rounds of one chunk per thread, transforms the chunks in parallel, and
+//writes them to the output in order.
+template<typename KeyStream>
+void transform_parallel(std::istream& input_file,std::ostream& output_file,
+		const typename KeyStream::Bit_Sequence& iv,const typename KeyStream::Bit_Sequence& key,
+		unsigned int num_threads){
+	//Thread i handles chunks i, i + num_threads, i + 2 * num_threads, etc.  Its keystream
+	//starts at its first chunk and jumps over the chunks of the other threads after each round.
+	vector<KeyStream> key_streams(num_threads,KeyStream(iv,key));
+	for(unsigned int thread = 0;thread < num_threads;++thread){
+		key_streams[thread].seek(static_cast<typename KeyStream::Offset>(thread) * CHUNK_SIZE);
+	}
+	const typename KeyStream::Offset other_chunks = static_cast<typename KeyStream::Offset>(num_threads - 1) * CHUNK_SIZE * 8;
 
-	std::ifstream input_file(input_filename.c_str(),std::ios::binary|std::ios::in);
-	std::ofstream output_file(output_filename.c_str(),std::ios::binary|std::ios::out);
+	vector<char> buffer(num_threads * CHUNK_SIZE);
+	while(input_file){
+		input_file.read(buffer.data(),buffer.size());
+		std::size_t length = input_file.gcount();
+
+		vector<std::thread> threads;
+		for(unsigned int thread = 0;thread < num_threads && thread * CHUNK_SIZE < length;++thread){
+			std::size_t begin = thread * CHUNK_SIZE;
+			std::size_t chunk_length = std::min(CHUNK_SIZE,length - begin);
+			threads.push_back(std::thread([&,thread,begin,chunk_length](){
+				key_streams[thread].xor_into(buffer.data() + begin,chunk_length);
+				key_streams[thread].skip(other_chunks);
+			}));
+		}
+		for(auto& c_thread:threads){
+			c_thread.join();
+		}
+		output_file.write(buffer.data(),length);
+	}
+}
+
+//Copies the input to the output and xors it with the keystream.  The input is divided into one
+//contiguous range per thread.  Each range is copied a chunk at a time, and the chunk is xored
+//while it is still in the cache.
+template<typename KeyStream>
+void transform_mapped(const char* input,char* output,std::size_t length,
+		const typename KeyStream::Bit_Sequence& iv,const typename KeyStream::Bit_Sequence& key,
+		unsigned int num_threads){
+	auto transform_range = [&](std::size_t begin,std::size_t end){
+		KeyStream key_stream(iv,key);
+		key_stream.seek(begin);
+		for(std::size_t chunk = begin;chunk < end;chunk += CHUNK_SIZE){
+			std::size_t chunk_length = std::min(CHUNK_SIZE,end - chunk);
+			std::copy(input + chunk,input + chunk + chunk_length,output + chunk);
+			key_stream.xor_into(output + chunk,chunk_length);
+		}
+	};
+	std::size_t range_length = (length + num_threads - 1) / num_threads;
+	//The first range is transformed by this thread.
+	vector<std::thread> threads;
+	for(unsigned int thread = 1;thread < num_threads && thread * range_length < length;++thread){
+		std::size_t begin = thread * range_length;
+		threads.push_back(std::thread(transform_range,begin,std::min(begin + range_length,length)));
+	}
+	transform_range(0,std::min(range_length,length));
+	for(auto& c_thread:threads){
+		c_thread.join();
+	}
+}
+
+//Encrypts or decrypts the file with a register of the specified length.
+template<unsigned int Length>
+int run(const string& input_filename,const string& output_filename,const string& key_filename,
+		unsigned int num_threads){
+	typedef BasicKeyStream<Length> KeyStream;
 	std::ifstream key_file(key_filename.c_str(),std::ios::binary|std::ios::in);
 
-	KeyStream::Bit_Sequence key;
+	typename KeyStream::Bit_Sequence key;
 	key_file.read(reinterpret_cast<char*>(&key),sizeof(key));
 
 	cout << "Is the file being encrypted or decrypted (type \'e\' for encryption and \'d\' "
 			"for decryption): ";
 	char mode;
 	cin >> mode;
-	KeyStream::Bit_Sequence iv;
+	typename KeyStream::Bit_Sequence iv;
+	const std::size_t IV_SIZE = sizeof(typename KeyStream::Bit_Sequence);
+	if(mode != 'd'){
+		//Each word of the iv is a random number.
+		std::srand(std::time(NULL));
+		unsigned long int* iv_words = reinterpret_cast<unsigned long int*>(&iv);
+		for(unsigned int word = 0;word < IV_SIZE / sizeof(unsigned long int);++word){
+			iv_words[word] = std::rand();
+		}
+	}
 
+	//Try to map both files.  The output file is mapped with its final size, which depends on
+	//whether the iv is being removed or added.
+	MappedFile input_map(input_filename);
+	if(input_map.is_open() && (mode != 'd' || input_map.size() >= IV_SIZE)){
+		const char* input = input_map.data();
+		std::size_t length = input_map.size();
+		if(mode == 'd'){
+			std::copy(input,input + IV_SIZE,reinterpret_cast<char*>(&iv));
+			input += IV_SIZE;
+			length -= IV_SIZE;
+		}
+		MappedFile output_map(output_filename,mode == 'd' ? length : length + IV_SIZE);
+		if(output_map.is_open()){
+			char* output = output_map.data();
+			if(mode != 'd'){
+				output = std::copy(reinterpret_cast<char*>(&iv),reinterpret_cast<char*>(&iv) + IV_SIZE,output);
+			}
+			transform_mapped<KeyStream>(input,output,length,iv,key,num_threads);
+			return 0;
+		}
+	}
+
+	std::ifstream input_file(input_filename.c_str(),std::ios::binary|std::ios::in);
+	std::ofstream output_file(output_filename.c_str(),std::ios::binary|std::ios::out);
 	//If the file is being decrypted, read the iv from the file.  If it is being encrypted,
-	//generate it randomly and append it to the beginning of the file.
+	//append the iv that was generated to the beginning of the file.
 	if(mode == 'd'){
-		input_file.read(reinterpret_cast<char*>(&iv),sizeof(KeyStream::Bit_Sequence));
+		input_file.read(reinterpret_cast<char*>(&iv),IV_SIZE);
 
 	}else{
-		std::srand(std::time(NULL));
-		iv = std::rand();
-		output_file.write(reinterpret_cast<char*>(&iv),sizeof(KeyStream::Bit_Sequence));//and assign iv to it.
+		output_file.write(reinterpret_cast<char*>(&iv),IV_SIZE);
+	}
+	if(num_threads > 1){
+		transform_parallel<KeyStream>(input_file,output_file,iv,key,num_threads);
+		return 0;
 	}
 	KeyStream key_stream(iv,key);
 
+	vector<char> buffer(CHUNK_SIZE);
 	while(input_file){
-		//Extract a block of key from the keystream, read a block from the input file, xor
-		//them, and write the result to the output file.
-		char current_key;
-		key_stream >> current_key;
-
-
-		char current_input;
-		input_file.read(reinterpret_cast<char*>(&current_input),sizeof(char));
-
-		KeyStream::Bit_Sequence current_output = current_key ^ current_input;
-		output_file.write(reinterpret_cast<char*>(&current_output),sizeof(char));
+		//Read a block from the input file, xor it with the next block of the keystream, and
+		//write the result to the output file.  The last block may be shorter.
+		input_file.read(buffer.data(),buffer.size());
+		std::size_t length = input_file.gcount();
+		key_stream.xor_into(buffer.data(),length);
+		output_file.write(buffer.data(),length);
 	}
+	return 0;
+}
 
 
+int main(int argc,char* argv[]){
+	unsigned int num_threads = 1;
+	unsigned int num_cores = std::max(std::thread::hardware_concurrency(),1u);
+	if(argc > 1){
+		char* end;
+		long requested = std::strtol(argv[1],&end,10);
+		if(*argv[1] == '\0' || *end != '\0' || requested < 0){
+			std::cerr << "Usage: LFSR [num_threads [register_length]]" << endl
+					<< "The number of threads must be a number that is at least 0." << endl;
+			return 1;
+		}
+		//0 means one thread per core.  More threads than a few per core would not be any faster,
+		//and too many of them cannot be created.
+		num_threads = requested == 0 ? num_cores :
+				static_cast<unsigned int>(std::min<long>(requested,MAX_THREADS_PER_CORE * num_cores));
+	}
+	unsigned int register_length = 64;
+	if(argc > 2){
+		register_length = std::atoi(argv[2]);
+	}
+	string input_filename,key_filename,output_filename;
+	cout << "Enter the name of the input file: ";
+	cin >> input_filename;
+	cout << "Enter the name of the output file: ";
+	cin >> output_filename;
+	cout << "Enter the name of the file with the key (a binary file with " << register_length
+			<< " bits): ";
+	cin >> key_filename;
 
-
-
-	return 0;
+	switch(register_length){
+	case 64:
+		return run<64>(input_filename,output_filename,key_filename,num_threads);
+	case 128:
+		return run<128>(input_filename,output_filename,key_filename,num_threads);
+	case 256:
+		return run<256>(input_filename,output_filename,key_filename,num_threads);
+	case 512:
+		return run<512>(input_filename,output_filename,key_filename,num_threads);
+	case 1024:
+		return run<1024>(input_filename,output_filename,key_filename,num_threads);
+	default:
+		std::cerr << "The register length must be 64, 128, 256, 512 or 1024." << endl;
+		return 1;
+	}
 }
-
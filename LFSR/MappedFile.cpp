@@ -0,0 +1,81 @@
+/*
+ * File: MappedFile.cpp
+ * Author: Arthur Laks
+
+ Contains the definitions of the methods of the MappedFile class.  Memory mapping is implemented
+ with the POSIX mmap function.  On other platforms the files are never mapped, and the caller
+ falls back to streams.
+
+ */
+
+#include "MappedFile.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define HAVE_MMAP
+#endif
+
+namespace LSFR {
+
+	MappedFile::MappedFile(const std::string& filename):
+			contents(nullptr),length(0),mapped(false),descriptor(-1){
+#ifdef HAVE_MMAP
+		descriptor = open(filename.c_str(),O_RDONLY);
+		struct stat status;
+		//Only regular files can be mapped.
+		if(descriptor < 0 || fstat(descriptor,&status) != 0 || !S_ISREG(status.st_mode)){
+			return;
+		}
+		length = status.st_size;
+		//mmap does not accept an empty mapping, but there is nothing to read anyway.
+		if(length == 0){
+			mapped = true;
+			return;
+		}
+		void* address = mmap(nullptr,length,PROT_READ,MAP_SHARED,descriptor,0);
+		if(address == MAP_FAILED){
+			return;
+		}
+		//The file will be read from beginning to end, so let the kernel read ahead.
+		madvise(address,length,MADV_SEQUENTIAL);
+		contents = static_cast<char*>(address);
+		mapped = true;
+#endif
+	}
+
+	MappedFile::MappedFile(const std::string& filename,std::size_t size):
+			contents(nullptr),length(size),mapped(false),descriptor(-1){
+#ifdef HAVE_MMAP
+		//The file has to be opened for reading as well as writing in order to be mapped.
+		descriptor = open(filename.c_str(),O_RDWR | O_CREAT | O_TRUNC,0644);
+		if(descriptor < 0 || ftruncate(descriptor,size) != 0){
+			return;
+		}
+		if(length == 0){
+			mapped = true;
+			return;
+		}
+		void* address = mmap(nullptr,length,PROT_READ | PROT_WRITE,MAP_SHARED,descriptor,0);
+		if(address == MAP_FAILED){
+			return;
+		}
+		contents = static_cast<char*>(address);
+		mapped = true;
+#endif
+	}
+
+	MappedFile::~MappedFile(){
+#ifdef HAVE_MMAP
+		if(contents){
+			munmap(contents,length);
+		}
+		if(descriptor >= 0){
+			close(descriptor);
+		}
+#endif
+	}
+
+} /* namespace LSFR */
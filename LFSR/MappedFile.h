@@ -0,0 +1,49 @@
+/*
+ * File: MappedFile.h
+ * Author: Arthur Laks
+
+ * This file contains the definition of the MappedFile class, which maps a file into memory so
+ * that it can be transformed without copying it through a stream.
+
+ */
+
+#include <string>
+#include <cstddef>
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+namespace LSFR {
+class MappedFile {
+public:
+	//Maps an existing file for reading.
+	explicit MappedFile(const std::string& filename);
+	//Creates a file with the specified size, or truncates an existing one to that size, and maps
+	//it for writing.
+	MappedFile(const std::string& filename,std::size_t size);
+	~MappedFile();
+
+	//Returns false if the file could not be mapped, for example if it is a pipe or if memory
+	//mapping is not supported on this platform.  In that case the file should be accessed
+	//through a stream instead.
+	bool is_open() const{
+		return mapped;
+	}
+	char* data() const{
+		return contents;
+	}
+	std::size_t size() const{
+		return length;
+	}
+private:
+	//A mapping can't be shared between two objects.
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	char* contents;
+	std::size_t length;
+	bool mapped;
+	int descriptor;
+};
+
+} /* namespace LSFR */
+#endif /* MAPPEDFILE_H_ */
@@ -0,0 +1,94 @@
+/*
+ * File: Records.cpp
+ * Author: Arthur Laks
+ *
+ * This program encrypts or decrypts many small files, or records, at once with the 64 bit
+ * register.  Each record is encrypted with its own random iv, which is inserted at the beginning
+ * of its output file like in the LFSR program, so each output file can also be decrypted by
+ * it.  The records are transformed by a BatchKeyStream, 64 of them side by side.  The output
+ * files have the same names as the input files, in the output directory.
+
+ */
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <iterator>
+#include <ctime>
+#include <cstdlib>
+#include <cstring>
+#include "BatchKeyStream.h"
+using std::cerr;
+using std::endl;
+using std::vector;
+using std::string;
+
+using LSFR::BatchKeyStream;
+
+int main(int argc,char* argv[]){
+	if(argc < 5 || (std::strcmp(argv[1],"-e") != 0 && std::strcmp(argv[1],"-d") != 0)){
+		cerr << "Usage: Records -e|-d key_file output_directory input_file..." << endl;
+		return 1;
+	}
+	typedef BatchKeyStream::Bit_Sequence Bit_Sequence;
+	const std::size_t IV_SIZE = sizeof(Bit_Sequence);
+	bool encrypt = argv[1][1] == 'e';
+	std::ifstream key_file(argv[2],std::ios::binary|std::ios::in);
+	Bit_Sequence key;
+	if(!key_file.read(reinterpret_cast<char*>(&key),sizeof(key))){
+		cerr << "The key file does not exist or is too short." << endl;
+		return 2;
+	}
+	string output_directory = argv[3];
+	std::size_t num_records = argc - 4;
+
+	//Read the records.  In decryption mode each one starts with its iv, and in encryption mode
+	//a random iv is generated for it.
+	std::srand(std::time(NULL));
+	vector<vector<char> > records(num_records);
+	vector<Bit_Sequence> ivs(num_records);
+	vector<Bit_Sequence> keys(num_records,key);
+	for(std::size_t record = 0;record < num_records;++record){
+		std::ifstream input_file(argv[4 + record],std::ios::binary|std::ios::in);
+		if(!input_file){
+			cerr << argv[4 + record] << " does not exist." << endl;
+			return 2;
+		}
+		//The inner parentheses are to avoid the C++ most vexing parse.
+		records[record].assign(std::istreambuf_iterator<char>(input_file),(std::istreambuf_iterator<char>()));
+		if(encrypt){
+			ivs[record] = static_cast<Bit_Sequence>(std::rand());
+		}else{
+			if(records[record].size() < IV_SIZE){
+				cerr << argv[4 + record] << " is too short to contain an iv." << endl;
+				return 2;
+			}
+			std::copy(records[record].begin(),records[record].begin() + IV_SIZE,reinterpret_cast<char*>(&ivs[record]));
+			records[record].erase(records[record].begin(),records[record].begin() + IV_SIZE);
+		}
+	}
+
+	vector<char*> buffers(num_records);
+	vector<std::size_t> lengths(num_records);
+	for(std::size_t record = 0;record < num_records;++record){
+		buffers[record] = records[record].data();
+		lengths[record] = records[record].size();
+	}
+	BatchKeyStream::xor_records(num_records,ivs.data(),keys.data(),buffers.data(),lengths.data());
+
+	for(std::size_t record = 0;record < num_records;++record){
+		string input_filename = argv[4 + record];
+		string output_filename = output_directory + "/" + input_filename.substr(input_filename.find_last_of('/') + 1);
+		std::ofstream output_file(output_filename.c_str(),std::ios::binary|std::ios::out);
+		if(!output_file){
+			cerr << "Could not create " << output_filename << "." << endl;
+			return 2;
+		}
+		if(encrypt){
+			output_file.write(reinterpret_cast<const char*>(&ivs[record]),IV_SIZE);
+		}
+		output_file.write(records[record].data(),records[record].size());
+	}
+	return 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * File: Register.h
+ * Author: Arthur Laks
+
+ * This file contains the Register template, which implements the bitwise operations that the
+ * KeyStream class performs on packed shift registers of any length.
+
+ */
+
+#include <array>
+#include <bitset>
+#ifndef REGISTER_H_
+#define REGISTER_H_
+
+namespace LSFR {
+//A register longer than a word is stored in an array of words.  Bit i of the register is bit
+//i % WORD_BITS of word i / WORD_BITS, so writing the array to a file writes the bits in the
+//same order as a single word would.  Every loop is over a number of words that is known at
+//compile time, so the compiler unrolls them.
+template<unsigned int Length>
+struct Register {
+	typedef unsigned long int Word;
+	static const unsigned int WORD_BITS = sizeof(Word) * 8;
+	static const unsigned int WORDS = Length / WORD_BITS;
+	static_assert(Length % WORD_BITS == 0,"The length of a register must be a multiple of a word.");
+	typedef std::array<Word,WORDS> Type;
+
+	static Type from_word(Word word){
+		Type retval;
+		retval.fill(0);
+		retval[0] = word;
+		return retval;
+	}
+	static bool bit(const Type& value,unsigned int index){
+		return (value[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+	}
+	//Sets the bit at the index if the argument is true, without branching.
+	static void set_bit(Type& value,unsigned int index,bool bit = true){
+		value[index / WORD_BITS] |= static_cast<Word>(bit) << (index % WORD_BITS);
+	}
+	//Returns byte n of the register, where byte 0 holds the bits 0 through 7.
+	static unsigned char byte(const Type& value,unsigned int n){
+		return static_cast<unsigned char>(value[n / sizeof(Word)] >> ((n % sizeof(Word)) * 8));
+	}
+
+	//Shifts the bits toward the end of the register by n positions, where n is less than Length.
+	static Type shift_left(const Type& value,unsigned int n){
+		const unsigned int words = n / WORD_BITS;
+		const unsigned int bits = n % WORD_BITS;
+		Type retval;
+		for(unsigned int word = 0;word < WORDS;++word){
+			Word shifted = 0;
+			if(word >= words){
+				shifted = value[word - words] << bits;
+				//Shifting a word by its whole length is undefined, so skip the carry if bits is 0.
+				if(bits && word > words){
+					shifted |= value[word - words - 1] >> (WORD_BITS - bits);
+				}
+			}
+			retval[word] = shifted;
+		}
+		return retval;
+	}
+	//Shifts the bits toward the front of the register by n positions, where n is less than
+	//Length.
+	static Type shift_right(const Type& value,unsigned int n){
+		const unsigned int words = n / WORD_BITS;
+		const unsigned int bits = n % WORD_BITS;
+		Type retval;
+		for(unsigned int word = 0;word < WORDS;++word){
+			Word shifted = 0;
+			if(word + words < WORDS){
+				shifted = value[word + words] >> bits;
+				if(bits && word + words + 1 < WORDS){
+					shifted |= value[word + words + 1] << (WORD_BITS - bits);
+				}
+			}
+			retval[word] = shifted;
+		}
+		return retval;
+	}
+
+	static Type bitwise_or(const Type& a,const Type& b){
+		Type retval;
+		for(unsigned int word = 0;word < WORDS;++word){
+			retval[word] = a[word] | b[word];
+		}
+		return retval;
+	}
+	static Type bitwise_xor(const Type& a,const Type& b){
+		Type retval;
+		for(unsigned int word = 0;word < WORDS;++word){
+			retval[word] = a[word] ^ b[word];
+		}
+		return retval;
+	}
+	//Returns the argument if the condition is true, or zero otherwise, without branching.
+	static Type select(const Type& value,bool condition){
+		Type retval;
+		const Word mask = -static_cast<Word>(condition);
+		for(unsigned int word = 0;word < WORDS;++word){
+			retval[word] = value[word] & mask;
+		}
+		return retval;
+	}
+
+	//This is the feedback kernel.  The xor of all the bits of a & b is the xor of all the bits of
+	//the xor of its words, so only one parity has to be computed.
+	static bool parity_of_and(const Type& a,const Type& b){
+		Word combined = 0;
+		for(unsigned int word = 0;word < WORDS;++word){
+			combined ^= a[word] & b[word];
+		}
+		return parity(combined);
+	}
+
+	//Returns the xor of all of the bits of the word.
+	static bool parity(Word word){
+#ifdef __GNUC__
+		return __builtin_parityl(word);
+#else
+		return std::bitset<WORD_BITS>(word).count() % 2;
+#endif
+	}
+};
+
+//A register that fits in a single word is stored in it directly, and every operation is a
+//single instruction.
+template<>
+struct Register<sizeof(unsigned long int) * 8> {
+	typedef unsigned long int Word;
+	static const unsigned int WORD_BITS = sizeof(Word) * 8;
+	static const unsigned int WORDS = 1;
+	typedef Word Type;
+
+	static Type from_word(Word word){
+		return word;
+	}
+	static bool bit(Type value,unsigned int index){
+		return (value >> index) & 1;
+	}
+	static void set_bit(Type& value,unsigned int index,bool bit = true){
+		value |= static_cast<Word>(bit) << index;
+	}
+	static unsigned char byte(Type value,unsigned int n){
+		return static_cast<unsigned char>(value >> (n * 8));
+	}
+	static Type shift_left(Type value,unsigned int n){
+		return value << n;
+	}
+	static Type shift_right(Type value,unsigned int n){
+		return value >> n;
+	}
+	static Type bitwise_or(Type a,Type b){
+		return a | b;
+	}
+	static Type bitwise_xor(Type a,Type b){
+		return a ^ b;
+	}
+	static Type select(Type value,bool condition){
+		return value & -static_cast<Word>(condition);
+	}
+	static bool parity_of_and(Type a,Type b){
+		return parity(a & b);
+	}
+	static bool parity(Word word){
+#ifdef __GNUC__
+		return __builtin_parityl(word);
+#else
+		return std::bitset<WORD_BITS>(word).count() % 2;
+#endif
+	}
+};
+
+} /* namespace LSFR */
+#endif /* REGISTER_H_ */
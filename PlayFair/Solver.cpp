@@ -0,0 +1,373 @@
+/*
+ * File: Solver.cpp
+ * Author: Arthur Laks
+ *
+ * This is a ciphertext-only attack on the 6x6 PlayFair cipher.  It searches for the table by
+ * simulated annealing: starting from a random table, it repeatedly swaps two characters, two
+ * rows or two columns, or reverses the order of the rows or columns, and keeps the change if the
+ * decryption looks more like English according to quadgram statistics, or sometimes even if it
+ * looks less like English, less often as the temperature drops.  Each thread runs independent
+ * restarts until one of them finds a decryption that scores like English, or the time runs out.
+ * The table that is found is printed as a 36 character key, which can be passed to PlayFair to
+ * decrypt the file.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include "table.h"
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::vector;
+using std::string;
+
+typedef Playfair<Extended_Alphabet> Cipher;
+const int SIDE = Cipher::SIDE;	//The number of rows and columns of the table.
+const size_t TABLE_LENGTH = Cipher::SIZE;	//The number of characters in the table.
+//The temperature that each restart starts from, per character of ciphertext, and the amount
+//it drops by after each round of changes.
+const double START_TEMPERATURE = 0.02;
+const double TEMPERATURE_STEP = 0.001;
+//The number of changes that are tried at each temperature.
+const int CHANGES_PER_TEMPERATURE = 4000;
+//Equivalent tables, such as the ones whose rows or columns are rotated, produce the same
+//decryption, so when two restarts reach the same score they have most likely both found the
+//real table.  A score is only accepted if its average is within this much of the average score
+//of the text that the statistics came from.
+const double SOLVED_MARGIN = 1.5;
+
+//Stores the logarithm of the probability of every sequence of four characters of the table
+//alphabet in English, indexed by their indices in the alphabet as a number in base 36.
+class Quadgram_Table{
+public:
+	//Reads the counts from a file where each line has a quadgram and its count.  Lines that
+	//start with '#' are ignored.  Returns false if the file could not be read.
+	bool load(const string& filename);
+	float score(const unsigned char* text) const{
+		return table[((text[0] * TABLE_LENGTH + text[1]) * TABLE_LENGTH + text[2]) * TABLE_LENGTH + text[3]];
+	}
+	//The average score of the quadgrams that were counted.
+	double average() const{
+		return average_score;
+	}
+private:
+	vector<float> table;
+	double average_score;
+};
+
+//The index in the alphabet of each character, or -1 if it is not in the alphabet.
+vector<int> alphabet_indices(){
+	vector<int> indices(256,-1);
+	for(size_t index = 0;index < TABLE_LENGTH;++index){
+		indices[static_cast<unsigned char>(Extended_Alphabet::character(index))] = index;
+	}
+	return indices;
+}
+
+bool Quadgram_Table::load(const string& filename){
+	std::ifstream file(filename.c_str());
+	if(!file){
+		return false;
+	}
+	vector<int> indices = alphabet_indices();
+	vector<double> counts(TABLE_LENGTH * TABLE_LENGTH * TABLE_LENGTH * TABLE_LENGTH,0);
+	double total = 0;
+	string quadgram;
+	double count;
+	while(file >> quadgram){
+		//Skip comments.
+		if(quadgram[0] == '#'){
+			std::getline(file,quadgram);
+			continue;
+		}
+		file >> count;
+		int index = 0;
+		bool valid = quadgram.size() == 4;
+		for(char character:quadgram){
+			valid = valid && indices[static_cast<unsigned char>(character)] >= 0;
+			index = index * TABLE_LENGTH + std::max(indices[static_cast<unsigned char>(character)],0);
+		}
+		if(valid){
+			counts[index] += count;
+			total += count;
+		}
+	}
+	if(total == 0){
+		return false;
+	}
+	//A quadgram that was never seen is treated as if it had been seen a hundredth of a time.
+	table.resize(counts.size());
+	average_score = 0;
+	for(size_t index = 0;index < counts.size();++index){
+		table[index] = std::log10((counts[index] ? counts[index] : 0.01) / total);
+		average_score += counts[index] * table[index] / total;
+	}
+	return true;
+}
+
+//The positions that a pair of characters at two positions of the table decrypts to depend only
+//on the positions, so they are calculated once for every pair.  Entry first * TABLE_LENGTH +
+//second holds the two positions whose characters are the plaintext.
+struct Decryption_Positions{
+	unsigned char positions[TABLE_LENGTH * TABLE_LENGTH][2];
+	Decryption_Positions(){
+		for(int first = 0;first < static_cast<int>(TABLE_LENGTH);++first){
+			for(int second = 0;second < static_cast<int>(TABLE_LENGTH);++second){
+				unsigned char* result = positions[first * TABLE_LENGTH + second];
+				result[0] = Cipher::decrypted_position(first,second,0);
+				result[1] = Cipher::decrypted_position(first,second,1);
+			}
+		}
+	}
+};
+const Decryption_Positions DECRYPTION_POSITIONS;
+
+//A candidate table, stored as the alphabet index of the character at each position and the
+//position of each character.
+struct Candidate{
+	unsigned char cells[TABLE_LENGTH];
+	unsigned char positions[TABLE_LENGTH];
+
+	void set(int position,unsigned char character){
+		cells[position] = character;
+		positions[character] = position;
+	}
+	void swap_cells(int first,int second){
+		unsigned char first_character = cells[first];
+		set(first,cells[second]);
+		set(second,first_character);
+	}
+	void swap_rows(int first,int second){
+		for(int column = 0;column < SIDE;++column){
+			swap_cells(first * SIDE + column,second * SIDE + column);
+		}
+	}
+	void swap_columns(int first,int second){
+		for(int row = 0;row < SIDE;++row){
+			swap_cells(row * SIDE + first,row * SIDE + second);
+		}
+	}
+	//Decrypts the ciphertext, which has an even number of alphabet indices, into the plaintext.
+	void decrypt(const vector<unsigned char>& ciphertext,vector<unsigned char>& plaintext) const{
+		for(size_t index = 0;index < ciphertext.size();index += 2){
+			const unsigned char* result = DECRYPTION_POSITIONS.positions[positions[ciphertext[index]] * TABLE_LENGTH +
+					positions[ciphertext[index + 1]]];
+			plaintext[index] = cells[result[0]];
+			plaintext[index + 1] = cells[result[1]];
+		}
+	}
+	//Returns the table as a string of characters, which is also a key that produces it.
+	string key() const{
+		string retval;
+		for(unsigned char character:cells){
+			retval.push_back(Extended_Alphabet::character(character));
+		}
+		return retval;
+	}
+};
+
+//The best table found by any of the threads, and whether it is good enough to stop.
+struct Shared_Result{
+	std::mutex mutex;
+	Candidate best;
+	double best_fitness;
+	//The number of restarts that reached best_fitness.
+	int times_found;
+	std::atomic<bool> solved;
+	std::atomic<unsigned long> restarts;
+};
+
+//Scores the decryption of the ciphertext with a table.
+double fitness(const Quadgram_Table& quadgrams,const Candidate& candidate,const vector<unsigned char>& ciphertext,
+		vector<unsigned char>& plaintext){
+	candidate.decrypt(ciphertext,plaintext);
+	double total = 0;
+	for(size_t start = 0;start + 4 <= plaintext.size();++start){
+		total += quadgrams.score(&plaintext[start]);
+	}
+	return total;
+}
+
+//Runs restarts of the annealing until the result is solved or the deadline passes.
+void anneal(const Quadgram_Table& quadgrams,const vector<unsigned char>& ciphertext,unsigned int seed,
+		std::chrono::steady_clock::time_point deadline,Shared_Result& shared){
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<double> uniform(0,1);
+	std::uniform_int_distribution<int> random_position(0,TABLE_LENGTH - 1);
+	std::uniform_int_distribution<int> random_line(0,SIDE - 1);
+	vector<unsigned char> plaintext(ciphertext.size());
+	size_t num_quadgrams = ciphertext.size() - 3;
+	double threshold = (quadgrams.average() - SOLVED_MARGIN) * num_quadgrams;
+
+	while(!shared.solved && std::chrono::steady_clock::now() < deadline){
+		++shared.restarts;
+		Candidate parent;
+		vector<unsigned char> order(TABLE_LENGTH);
+		for(size_t index = 0;index < TABLE_LENGTH;++index){
+			order[index] = index;
+		}
+		std::shuffle(order.begin(),order.end(),generator);
+		for(size_t index = 0;index < TABLE_LENGTH;++index){
+			parent.set(index,order[index]);
+		}
+		double parent_fitness = fitness(quadgrams,parent,ciphertext,plaintext);
+		Candidate best = parent;
+		double best_fitness = parent_fitness;
+
+		for(double temperature = START_TEMPERATURE * ciphertext.size();temperature > 0 && !shared.solved;
+				temperature -= TEMPERATURE_STEP * ciphertext.size()){
+			for(int change = 0;change < CHANGES_PER_TEMPERATURE;++change){
+				Candidate child = parent;
+				int kind = random_position(generator);
+				if(kind < 31){
+					child.swap_cells(random_position(generator),random_position(generator));
+				}else if(kind < 33){
+					child.swap_rows(random_line(generator),random_line(generator));
+				}else if(kind < 35){
+					child.swap_columns(random_line(generator),random_line(generator));
+				}else{
+					//Reverse the order of the rows.
+					for(int row = 0;row < SIDE / 2;++row){
+						child.swap_rows(row,SIDE - 1 - row);
+					}
+				}
+				double child_fitness = fitness(quadgrams,child,ciphertext,plaintext);
+				double difference = child_fitness - parent_fitness;
+				if(difference >= 0 || uniform(generator) < std::exp(difference / temperature)){
+					parent = child;
+					parent_fitness = child_fitness;
+					if(parent_fitness > best_fitness){
+						best = parent;
+						best_fitness = parent_fitness;
+					}
+				}
+			}
+			if(std::chrono::steady_clock::now() >= deadline){
+				break;
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(shared.mutex);
+		//The sums of the same scores in a different order can differ slightly.
+		if(std::abs(best_fitness - shared.best_fitness) < 1e-6 * num_quadgrams){
+			++shared.times_found;
+		}else if(best_fitness > shared.best_fitness){
+			shared.best = best;
+			shared.best_fitness = best_fitness;
+			shared.times_found = 1;
+		}
+		if(shared.times_found >= 2 && shared.best_fitness >= threshold){
+			shared.solved = true;
+		}
+	}
+}
+
+int main(int argc,char* args[]){
+	unsigned int num_threads = std::max(std::thread::hardware_concurrency(),1u);
+	double seconds = 60;
+	const char* filename = nullptr;
+	//Look for the statistics next to the executable by default.
+	string ngram_filename = args[0];
+	ngram_filename = ngram_filename.substr(0,ngram_filename.find_last_of('/') + 1) + "english_ngrams.txt";
+	for(int arg = 1;arg < argc;++arg){
+		if(std::strcmp(args[arg],"-t") == 0 && arg + 1 < argc){
+			num_threads = std::max(std::atoi(args[++arg]),1);
+		}else if(std::strcmp(args[arg],"-s") == 0 && arg + 1 < argc){
+			seconds = std::atof(args[++arg]);
+		}else if(std::strcmp(args[arg],"-n") == 0 && arg + 1 < argc){
+			ngram_filename = args[++arg];
+		}else{
+			filename = args[arg];
+		}
+	}
+	if(!filename){
+		cerr << "Usage: Solver [-t threads] [-s seconds] [-n ngram_filename] ciphertext_filename" << endl;
+		return 1;
+	}
+	Quadgram_Table quadgrams;
+	if(!quadgrams.load(ngram_filename)){
+		cerr << "Could not read " << ngram_filename << "." << endl;
+		return 2;
+	}
+	std::ifstream input(filename);
+	if(!input){
+		cerr << "File does not exist." << endl;
+		return 2;
+	}
+	//Read the ciphertext, skipping whitespace, and convert it to alphabet indices.
+	vector<int> indices = alphabet_indices();
+	vector<unsigned char> ciphertext;
+	string ciphertext_chars;
+	char character;
+	while(input >> character){
+		if(indices[static_cast<unsigned char>(character)] < 0){
+			cerr << "The ciphertext contains '" << character << "', which is not in the table." << endl;
+			return 2;
+		}
+		ciphertext.push_back(indices[static_cast<unsigned char>(character)]);
+		ciphertext_chars.push_back(character);
+	}
+	if(ciphertext.size() % 2){
+		cerr << "The ciphertext has an odd number of characters, so the last one was ignored." << endl;
+		ciphertext.pop_back();
+		ciphertext_chars.pop_back();
+	}
+	if(ciphertext.size() < 4){
+		cerr << "The ciphertext is too short to analyze." << endl;
+		return 3;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(seconds));
+	Shared_Result shared;
+	shared.best_fitness = -1e300;
+	shared.times_found = 0;
+	shared.solved = false;
+	shared.restarts = 0;
+	std::random_device random_device;
+	unsigned int seed = random_device();
+	vector<std::thread> threads;
+	for(unsigned int thread = 1;thread < num_threads;++thread){
+		threads.push_back(std::thread(anneal,std::cref(quadgrams),std::cref(ciphertext),seed + thread,deadline,
+				std::ref(shared)));
+	}
+	anneal(quadgrams,ciphertext,seed,deadline,shared);
+	for(auto& c_thread:threads){
+		c_thread.join();
+	}
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	string key = shared.best.key();
+	cout << (shared.solved ? "Solved" : "Not solved") << " after " << shared.restarts << " restarts in "
+			<< elapsed << " seconds." << endl;
+	cout << "Average quadgram score: " << shared.best_fitness / (ciphertext.size() - 3)
+			<< " (English: " << quadgrams.average() << ")" << endl;
+	cout << "Table:" << endl;
+	for(int row = 0;row < SIDE;++row){
+		cout << key.substr(row * SIDE,SIDE) << endl;
+	}
+	cout << "Key: " << key << endl;
+	//Decrypt the ciphertext with the same tables as PlayFair.
+	Cipher cipher(key);
+	string plaintext;
+	for(size_t index = 0;index < ciphertext_chars.size();index += 2){
+		auto decrypted = cipher.decrypt(ciphertext_chars[index],ciphertext_chars[index + 1]);
+		plaintext.push_back(decrypted.first);
+		plaintext.push_back(decrypted.second);
+	}
+	cout << "Plaintext: " << plaintext << endl;
+	return shared.solved ? 0 : 3;
+}
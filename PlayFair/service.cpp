@@ -0,0 +1,392 @@
+/*
+ * File: service.cpp
+ * Author: Arthur Laks
+ *
+ * This file contains the implementation of the service mode.  Each connection has a thread that
+ * reads the requests and passes them to the pool of workers, and a thread that waits for them
+ * to be finished in order and writes the responses.
+ */
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <set>
+#include <chrono>
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include "service.h"
+#include "transform.h"
+using std::vector;
+using std::string;
+using std::shared_ptr;
+
+//The longest key and text that are accepted.  A request that is longer ends the connection,
+//because it is most likely not a request at all.
+const std::size_t MAX_KEY_LENGTH = 1 << 12;
+const std::size_t MAX_TEXT_LENGTH = 1 << 26;
+//The number of requests per worker that can be read from a connection before the responses to
+//the earlier ones are written, which limits the memory that a connection can use.
+const std::size_t OUTSTANDING_PER_THREAD = 4;
+
+Table_Cache::Table_Cache(std::size_t capacity):capacity(capacity ? capacity : 1){
+}
+
+shared_ptr<const Service_Cipher> Table_Cache::get(const string& key){
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto found = index.find(key);
+		if(found != index.end()){
+			//Move the entry to the front.
+			entries.splice(entries.begin(),entries,found->second);
+			return found->second->second;
+		}
+	}
+	for(char character:key){
+		if(!Service_Cipher::in_alphabet(character)){
+			return nullptr;
+		}
+	}
+	//Build the tables without holding the lock, so that other keys can be looked up meanwhile.
+	shared_ptr<const Service_Cipher> cipher = std::make_shared<const Service_Cipher>(key);
+	std::lock_guard<std::mutex> lock(mutex);
+	auto found = index.find(key);
+	if(found != index.end()){
+		//Another thread built the same tables first.
+		entries.splice(entries.begin(),entries,found->second);
+		return found->second->second;
+	}
+	entries.push_front(std::make_pair(key,cipher));
+	index[key] = entries.begin();
+	if(entries.size() > capacity){
+		index.erase(entries.back().first);
+		entries.pop_back();
+	}
+	return cipher;
+}
+
+namespace{
+
+//A fixed number of threads that run tasks in the order that they were submitted.
+class Worker_Pool{
+public:
+	explicit Worker_Pool(unsigned int num_threads):stopping(false){
+		for(unsigned int thread = 0;thread < num_threads;++thread){
+			threads.push_back(std::thread(&Worker_Pool::work,this));
+		}
+	}
+	~Worker_Pool(){
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		available.notify_all();
+		for(auto& c_thread:threads){
+			c_thread.join();
+		}
+	}
+	void submit(std::function<void()> task){
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			tasks.push_back(std::move(task));
+		}
+		available.notify_one();
+	}
+private:
+	void work(){
+		while(true){
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				available.wait(lock,[this](){ return stopping || !tasks.empty(); });
+				if(tasks.empty()){
+					return;
+				}
+				task = std::move(tasks.front());
+				tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+	vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable available;
+	std::deque<std::function<void()> > tasks;
+	bool stopping;
+};
+
+//A request and, once it is done, its response.
+struct Job{
+	string key;
+	bool encrypt;
+	vector<char> text;
+	bool done;
+	bool failed;
+	vector<char> result;	//The transformed text, or the error message.
+};
+
+//The requests of a connection whose responses were not written yet, in order.
+struct Connection{
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::deque<shared_ptr<Job> > jobs;
+	bool finished_reading;
+	Connection():finished_reading(false){
+	}
+};
+
+void set_error(Job& job,const char* message){
+	job.failed = true;
+	job.result.assign(message,message + std::strlen(message));
+}
+
+//Transforms the text of a request with the tables of its key.
+void process(Job& job,Table_Cache& cache){
+	shared_ptr<const Service_Cipher> cipher = cache.get(job.key);
+	if(!cipher){
+		set_error(job,"The key has a character that is not in the table.");
+		return;
+	}
+	Transformer<Extended_Alphabet> transformer(*cipher,job.encrypt);
+	job.result.reserve(job.text.size() + 1);
+	if(!transformer.add(job.text.data(),job.text.size(),job.result)){
+		set_error(job,"The text has a character that is not in the table.");
+	}else if(!transformer.finish(job.result)){
+		set_error(job,"The ciphertext has an odd number of characters.");
+	}
+	//The text is not needed any more, so free it before the response is written.
+	vector<char>().swap(job.text);
+}
+
+//Reads length bytes, unless the input ends first.  Returns the number of bytes that were read.
+std::size_t read_fully(int descriptor,char* buffer,std::size_t length){
+	std::size_t total = 0;
+	while(total < length){
+		ssize_t count = read(descriptor,buffer + total,length - total);
+		if(count < 0 && errno == EINTR){
+			continue;
+		}
+		if(count <= 0){
+			break;
+		}
+		total += count;
+	}
+	return total;
+}
+
+bool write_fully(int descriptor,const char* buffer,std::size_t length){
+	while(length){
+		ssize_t count = write(descriptor,buffer,length);
+		if(count < 0 && errno == EINTR){
+			continue;
+		}
+		if(count <= 0){
+			return false;
+		}
+		buffer += count;
+		length -= count;
+	}
+	return true;
+}
+
+bool read_length(int descriptor,std::size_t& length){
+	unsigned char bytes[4];
+	if(read_fully(descriptor,reinterpret_cast<char*>(bytes),4) != 4){
+		return false;
+	}
+	length = static_cast<std::size_t>(bytes[0]) << 24 | bytes[1] << 16 | bytes[2] << 8 | bytes[3];
+	return true;
+}
+
+//Reads the next request.  Returns false at the end of the input or if the request is invalid,
+//and in the second case sets the error of the job.
+bool read_request(int descriptor,Job& job){
+	std::size_t key_length,text_length;
+	char direction;
+	if(!read_length(descriptor,key_length)){
+		//The input ended between requests.
+		return false;
+	}
+	if(key_length > MAX_KEY_LENGTH){
+		set_error(job,"The key is too long.");
+		return false;
+	}
+	job.key.resize(key_length);
+	if(read_fully(descriptor,&job.key[0],key_length) != key_length || read_fully(descriptor,&direction,1) != 1 ||
+			!read_length(descriptor,text_length)){
+		set_error(job,"The request is incomplete.");
+		return false;
+	}
+	if(direction != 'e' && direction != 'd'){
+		set_error(job,"The direction must be 'e' or 'd'.");
+		return false;
+	}
+	if(text_length > MAX_TEXT_LENGTH){
+		set_error(job,"The text is too long.");
+		return false;
+	}
+	job.encrypt = direction == 'e';
+	job.text.resize(text_length);
+	if(read_fully(descriptor,job.text.data(),text_length) != text_length){
+		set_error(job,"The request is incomplete.");
+		return false;
+	}
+	return true;
+}
+
+//Writes the responses of a connection in order as they are finished, until all the requests
+//were read and answered.
+void write_responses(int descriptor,Connection& connection){
+	bool writable = true;
+	while(true){
+		shared_ptr<Job> job;
+		{
+			std::unique_lock<std::mutex> lock(connection.mutex);
+			connection.changed.wait(lock,[&](){
+				return connection.jobs.empty() ? connection.finished_reading : connection.jobs.front()->done;
+			});
+			if(connection.jobs.empty()){
+				return;
+			}
+			job = connection.jobs.front();
+			connection.jobs.pop_front();
+		}
+		//Let the reader know that there is room for another request.
+		connection.changed.notify_all();
+		//If the other side stopped reading, keep taking the responses so the reader is not
+		//blocked, but do not write them.
+		if(writable){
+			unsigned char header[5] = {static_cast<unsigned char>(job->failed),
+					static_cast<unsigned char>(job->result.size() >> 24),static_cast<unsigned char>(job->result.size() >> 16),
+					static_cast<unsigned char>(job->result.size() >> 8),static_cast<unsigned char>(job->result.size())};
+			writable = write_fully(descriptor,reinterpret_cast<char*>(header),5) &&
+					write_fully(descriptor,job->result.data(),job->result.size());
+		}
+	}
+}
+
+//Answers the requests that are read from one descriptor on another one, until the input ends.
+void serve_connection(int input_descriptor,int output_descriptor,Worker_Pool& pool,Table_Cache& cache,
+		std::size_t max_outstanding){
+	shared_ptr<Connection> connection = std::make_shared<Connection>();
+	std::thread writer(write_responses,output_descriptor,std::ref(*connection));
+	while(true){
+		shared_ptr<Job> job = std::make_shared<Job>();
+		job->done = false;
+		job->failed = false;
+		bool valid = read_request(input_descriptor,*job);
+		std::unique_lock<std::mutex> lock(connection->mutex);
+		connection->changed.wait(lock,[&](){ return connection->jobs.size() < max_outstanding; });
+		if(!valid){
+			//An invalid request is answered with its error, after which the connection ends,
+			//since the start of the next request is unknown.
+			if(job->failed){
+				job->done = true;
+				connection->jobs.push_back(job);
+			}
+			connection->finished_reading = true;
+			break;
+		}
+		connection->jobs.push_back(job);
+		lock.unlock();
+		pool.submit([job,connection,&cache](){
+			process(*job,cache);
+			{
+				std::lock_guard<std::mutex> lock(connection->mutex);
+				job->done = true;
+			}
+			connection->changed.notify_all();
+		});
+	}
+	connection->changed.notify_all();
+	writer.join();
+}
+
+}
+
+int run_service(unsigned int num_threads,std::size_t cache_size,const char* socket_path){
+	//A client that disconnects should end its connection, not the service.
+	std::signal(SIGPIPE,SIG_IGN);
+	Worker_Pool pool(num_threads);
+	Table_Cache cache(cache_size);
+	std::size_t max_outstanding = OUTSTANDING_PER_THREAD * num_threads;
+	if(!socket_path){
+		serve_connection(STDIN_FILENO,STDOUT_FILENO,pool,cache,max_outstanding);
+		return 0;
+	}
+
+	sockaddr_un address;
+	std::memset(&address,0,sizeof(address));
+	address.sun_family = AF_UNIX;
+	if(std::strlen(socket_path) >= sizeof(address.sun_path)){
+		std::cerr << "The socket path is too long." << std::endl;
+		return 1;
+	}
+	std::strcpy(address.sun_path,socket_path);
+	//Remove the socket of a previous run, if there is one, but refuse to replace anything else.
+	struct stat status;
+	if(lstat(socket_path,&status) == 0){
+		if(!S_ISSOCK(status.st_mode)){
+			std::cerr << socket_path << " exists and is not a socket." << std::endl;
+			return 2;
+		}
+		unlink(socket_path);
+	}
+	int listener = socket(AF_UNIX,SOCK_STREAM,0);
+	if(listener < 0 || bind(listener,reinterpret_cast<sockaddr*>(&address),sizeof(address)) != 0 ||
+			listen(listener,SOMAXCONN) != 0){
+		std::cerr << "Could not listen on " << socket_path << ": " << std::strerror(errno) << std::endl;
+		if(listener >= 0){
+			close(listener);
+		}
+		return 2;
+	}
+	//The descriptors of the connections that are being served.  The threads that serve them
+	//use the pool and the cache, so they have to finish before this function returns.
+	std::mutex connections_mutex;
+	std::condition_variable connection_ended;
+	std::set<int> connections;
+	while(true){
+		int client = accept(listener,nullptr,nullptr);
+		if(client < 0){
+			if(errno == EINTR || errno == ECONNABORTED || errno == EPROTO){
+				continue;
+			}
+			//Running out of descriptors or memory is temporary, so wait for some of the
+			//connections to end and try again.
+			if(errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM){
+				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+				continue;
+			}
+			std::cerr << "Could not accept a connection: " << std::strerror(errno) << std::endl;
+			break;
+		}
+		std::lock_guard<std::mutex> lock(connections_mutex);
+		connections.insert(client);
+		std::thread([client,&pool,&cache,max_outstanding,&connections_mutex,&connection_ended,&connections](){
+			serve_connection(client,client,pool,cache,max_outstanding);
+			//Remove the descriptor before closing it, so that it is not shut down after it was
+			//reused for another file.
+			std::lock_guard<std::mutex> lock(connections_mutex);
+			connections.erase(client);
+			close(client);
+			connection_ended.notify_all();
+		}).detach();
+	}
+	//End the connections that are still open and wait for their threads.
+	close(listener);
+	std::unique_lock<std::mutex> lock(connections_mutex);
+	for(int client:connections){
+		shutdown(client,SHUT_RDWR);
+	}
+	connection_ended.wait(lock,[&](){ return connections.empty(); });
+	return 2;
+}
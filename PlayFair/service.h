@@ -0,0 +1,56 @@
+/*
+ * File: service.h
+ * Author: Arthur Laks
+ *
+ * This file contains the service mode of PlayFair, which keeps running and answers requests to
+ * encrypt or decrypt text with one of several keys, so that a program that makes many small
+ * requests does not start a process and build the tables for each of them.
+ *
+ * Each request is the length of the key as a 4 byte big-endian number, the key, 'e' to encrypt
+ * or 'd' to decrypt, the length of the text as a 4 byte big-endian number, and the text.  Each
+ * response is a status byte, which is 0 for success and 1 for an error, the length of the body
+ * as a 4 byte big-endian number, and the body, which is the result or an error message.  The
+ * text is handled like the contents of a file in the file mode.  The responses on a connection
+ * are in the same order as the requests, but the requests are transformed concurrently by a
+ * pool of threads.
+ */
+
+#ifndef SERVICE_H
+#define SERVICE_H
+
+#include <string>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <cstddef>
+#include "table.h"
+
+typedef Playfair<Extended_Alphabet> Service_Cipher;
+
+//Stores the tables of the keys that were used most recently, up to a maximum number of them,
+//and builds the tables of other keys when they are requested.  It can be used by several
+//threads at once.
+class Table_Cache{
+public:
+	explicit Table_Cache(std::size_t capacity);
+	//Returns the tables for a key, or null if the key has a character that is not in the
+	//alphabet.  The tables stay valid as long as the pointer is kept, even if they are removed
+	//from the cache.
+	std::shared_ptr<const Service_Cipher> get(const std::string& key);
+private:
+	typedef std::list<std::pair<std::string,std::shared_ptr<const Service_Cipher> > > Entry_List;
+	std::size_t capacity;
+	std::mutex mutex;
+	//The entries, from the most recently used to the least recently used one.
+	Entry_List entries;
+	std::unordered_map<std::string,Entry_List::iterator> index;
+};
+
+//Answers requests from standard input on standard output until the end of the input, or, if
+//socket_path is not null, listens on a Unix socket at that path and answers the requests on
+//each connection.  Returns the exit code of the program.
+int run_service(unsigned int num_threads,std::size_t cache_size,const char* socket_path);
+
+#endif /* SERVICE_H */
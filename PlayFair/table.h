@@ -0,0 +1,256 @@
+/*
+ * File: table.h
+ * Author: Arthur Laks
+ *
+ * This file contains the PlayFair table and the lookup tables built from it, as a template
+ * that is specialized for the size of the grid and the alphabet.  The 6x6 variant of this
+ * project and the classic 5x5 cipher are both instances of it.  Because the size of the grid is
+ * a compile-time constant, the rows and columns of positions never have to be calculated with a
+ * division by a run-time value, and every pair of characters is encrypted or decrypted with a
+ * single load.  A fixed key can also build its tables at compile time, with
+ *
+ *     constexpr Playfair<Extended_Alphabet> cipher = Playfair<Extended_Alphabet>::from_literal("KEY");
+ *
+ * so that there is no setup cost when the program runs.  It is shared by the PlayFair program
+ * and the solver.
+ */
+
+#ifndef TABLE_H
+#define TABLE_H
+
+#include <string>
+#include <utility>
+#include <stdexcept>
+#include <cassert>
+
+//The alphabet of this project: 25 letters without Q, '*' for space and the 10 digits, in a 6x6
+//table.
+struct Extended_Alphabet{
+	static constexpr int SIDE = 6;
+	//Returns the character at an index, in the order that they are added to the table after
+	//the key.
+	static constexpr char character(int index){
+		return "ABCDEFGHIJKLMNOPRSTUVWXYZ*0123456789"[index];
+	}
+	//Returns the character that is used in place of a character.
+	static constexpr char normalize(char character){
+		return character;
+	}
+};
+
+//The classic alphabet of 25 letters in a 5x5 table, where J is written as I.
+struct Classic_Alphabet{
+	static constexpr int SIDE = 5;
+	static constexpr char character(int index){
+		return "ABCDEFGHIKLMNOPQRSTUVWXYZ"[index];
+	}
+	static constexpr char normalize(char character){
+		return character == 'J' ? 'I' : character;
+	}
+};
+
+//A sequence of the integers from 0 up to, but not including, a count, which constructors
+//expand into the elements of arrays.  It is built by joining two halves, so that the depth of
+//the template recursion is only the logarithm of the count.
+template<int... Indices>
+struct Index_Sequence{};
+
+template<typename First,typename Second>
+struct Join_Sequences;
+template<int... First,int... Second>
+struct Join_Sequences<Index_Sequence<First...>,Index_Sequence<Second...> >{
+	typedef Index_Sequence<First...,(sizeof...(First) + Second)...> type;
+};
+
+template<int Count>
+struct Make_Index_Sequence{
+	typedef typename Join_Sequences<typename Make_Index_Sequence<Count / 2>::type,
+			typename Make_Index_Sequence<Count - Count / 2>::type>::type type;
+};
+template<>
+struct Make_Index_Sequence<0>{
+	typedef Index_Sequence<> type;
+};
+template<>
+struct Make_Index_Sequence<1>{
+	typedef Index_Sequence<0> type;
+};
+
+template<typename Alphabet>
+class Playfair{
+public:
+	static constexpr int SIDE = Alphabet::SIDE;
+	//The number of characters in the table.
+	static constexpr int SIZE = SIDE * SIDE;
+
+	//Builds the tables for a key at run time.  The key is followed by the rest of the alphabet,
+	//and only the first occurrence of each character is kept.  Every character of the key must
+	//be in the alphabet, which the caller checks with in_alphabet.
+	explicit Playfair(const std::string& key);
+
+	//Builds the tables for a key that is a string literal, at compile time if the result is
+	//constexpr.  A character that is not in the alphabet is a compile-time error.
+	static constexpr Playfair from_literal(const char* key){
+		return Playfair(Cells(key,literal_length(key),typename Make_Index_Sequence<SIZE>::type()),
+				typename Make_Index_Sequence<SIZE>::type(),typename Make_Index_Sequence<256>::type(),
+				typename Make_Index_Sequence<2 * SIZE * SIZE>::type());
+	}
+
+	//Returns whether a character is in the alphabet, or is written as one that is.
+	static bool in_alphabet(char character){
+		return alphabet_index(Alphabet::normalize(character)) >= 0;
+	}
+	//Returns the character at a position of the table, which is row * SIDE + column.
+	char cell(int position) const{
+		return table[position];
+	}
+	//Returns the position of a character in the table, or -1 if it is not in the alphabet.
+	int position(char character) const{
+		return positions[static_cast<unsigned char>(character)];
+	}
+	//Encrypt or decrypt a pair of characters, which must be in the alphabet.
+	std::pair<char,char> encrypt(char first,char second) const{
+		const char* result = &encrypted[2 * digraph_index(first,second)];
+		return std::make_pair(result[0],result[1]);
+	}
+	std::pair<char,char> decrypt(char first,char second) const{
+		const char* result = &decrypted[2 * digraph_index(first,second)];
+		return std::make_pair(result[0],result[1]);
+	}
+
+	//Returns the position of the character that the pair of characters at positions first and
+	//second is encrypted to (if which is 0, the first one, and otherwise the second one).  This
+	//only depends on the positions, not on the key.
+	static constexpr int encrypted_position(int first,int second,int which){
+		//If they are on the same row, take the characters to the right, and if they are on the
+		//same column, take the characters below.  Otherwise take the characters in the other
+		//corners of the rectangle, on the same row.
+		return first / SIDE == second / SIDE ?
+					(which ? second : first) / SIDE * SIDE + ((which ? second : first) % SIDE + 1) % SIDE :
+				first % SIDE == second % SIDE ?
+					((which ? second : first) / SIDE + 1) % SIDE * SIDE + first % SIDE :
+				which ? second / SIDE * SIDE + first % SIDE : first / SIDE * SIDE + second % SIDE;
+	}
+	//The same for decryption, which takes the characters to the left and above instead.
+	static constexpr int decrypted_position(int first,int second,int which){
+		return first / SIDE == second / SIDE ?
+					(which ? second : first) / SIDE * SIDE + ((which ? second : first) % SIDE + SIDE - 1) % SIDE :
+				first % SIDE == second % SIDE ?
+					((which ? second : first) / SIDE + SIDE - 1) % SIDE * SIDE + first % SIDE :
+				which ? second / SIDE * SIDE + first % SIDE : first / SIDE * SIDE + second % SIDE;
+	}
+private:
+	//The characters of the table, computed from a key at compile time.  Character n of the
+	//table is the n-th character of the key followed by the alphabet that did not appear
+	//before it.
+	struct Cells{
+		char values[SIZE];
+		template<int... Indices>
+		constexpr Cells(const char* key,int key_length,Index_Sequence<Indices...>):
+				values{nth_distinct(key,key_length,0,Indices)...}{
+		}
+	};
+
+	static constexpr int literal_length(const char* key){
+		return *key ? 1 + literal_length(key + 1) : 0;
+	}
+	//Returns the index in the alphabet of a character, or -1 if it is not in it.  Start is the
+	//index to search from.
+	static constexpr int alphabet_index(char character,int start = 0){
+		return start == SIZE ? -1 :
+				Alphabet::character(start) == character ? start : alphabet_index(character,start + 1);
+	}
+	//Returns the character at an index of the key followed by the alphabet.
+	static constexpr char combined(const char* key,int key_length,int index){
+		return index >= key_length ? Alphabet::character(index - key_length) :
+				alphabet_index(Alphabet::normalize(key[index])) >= 0 ? Alphabet::normalize(key[index]) :
+				throw std::invalid_argument("The key contains a character that is not in the alphabet.");
+	}
+	//Returns whether a character appears in the key followed by the alphabet before an index.
+	static constexpr bool appears_before(const char* key,int key_length,int index,char character){
+		return index > 0 && (combined(key,key_length,index - 1) == character ||
+				appears_before(key,key_length,index - 1,character));
+	}
+	//Returns the n-th character that did not appear before it, counting from an index.
+	static constexpr char nth_distinct(const char* key,int key_length,int index,int n){
+		return appears_before(key,key_length,index,combined(key,key_length,index)) ?
+				nth_distinct(key,key_length,index + 1,n) :
+				n == 0 ? combined(key,key_length,index) : nth_distinct(key,key_length,index + 1,n - 1);
+	}
+	//Returns the position of a character in the cells, or -1 if it is not in them.
+	static constexpr int find(const Cells& cells,char character,int start = 0){
+		return start == SIZE ? -1 :
+				cells.values[start] == character ? start : find(cells,character,start + 1);
+	}
+
+	template<int... Cell_Indices,int... Characters,int... Digraph_Indices>
+	constexpr Playfair(const Cells& cells,Index_Sequence<Cell_Indices...>,Index_Sequence<Characters...>,
+			Index_Sequence<Digraph_Indices...>):
+			table{cells.values[Cell_Indices]...},
+			positions{static_cast<signed char>(find(cells,Alphabet::normalize(static_cast<char>(Characters))))...},
+			encrypted{cells.values[encrypted_position(Digraph_Indices / 2 / SIZE,Digraph_Indices / 2 % SIZE,
+					Digraph_Indices % 2)]...},
+			decrypted{cells.values[decrypted_position(Digraph_Indices / 2 / SIZE,Digraph_Indices / 2 % SIZE,
+					Digraph_Indices % 2)]...}{
+	}
+
+	//Returns the index in the digraph tables of a pair of characters.
+	int digraph_index(char first,char second) const{
+		int first_position = position(first);
+		int second_position = position(second);
+		assert(first_position >= 0 && second_position >= 0 && "The character is not in the table.");
+		return first_position * SIZE + second_position;
+	}
+
+	char table[SIZE];
+	//The position of each character in the table, as row * SIDE + column, or -1 if the
+	//character is not in the table.  It is indexed by the character as an unsigned char.
+	signed char positions[256];
+	//The pairs of characters that each pair is encrypted and decrypted to.  The pair of the
+	//characters at positions first and second of the table is at index 2 * (first * SIZE +
+	//second).
+	char encrypted[2 * SIZE * SIZE];
+	char decrypted[2 * SIZE * SIZE];
+};
+
+template<typename Alphabet>
+Playfair<Alphabet>::Playfair(const std::string& key){
+	//Add the characters of the key and then the alphabet to the table, skipping the ones that
+	//were already added.
+	bool added[256] = {};
+	int count = 0;
+	std::string sequence = key;
+	for(int index = 0;index < SIZE;++index){
+		sequence.push_back(Alphabet::character(index));
+	}
+	for(char character:sequence){
+		character = Alphabet::normalize(character);
+		//The callers check the key, so this is only an internal error.  Skipping the character
+		//keeps the table in bounds even if asserts are disabled.
+		assert(alphabet_index(character) >= 0 && "The key contains a character that is not in the alphabet.");
+		if(alphabet_index(character) < 0){
+			continue;
+		}
+		if(!added[static_cast<unsigned char>(character)]){
+			added[static_cast<unsigned char>(character)] = true;
+			table[count++] = character;
+		}
+	}
+	for(int character = 0;character < 256;++character){
+		positions[character] = -1;
+	}
+	for(int position = 0;position < SIZE;++position){
+		positions[static_cast<unsigned char>(table[position])] = position;
+	}
+	//Characters that are written as another character have the same position.
+	for(int character = 0;character < 256;++character){
+		positions[character] = positions[static_cast<unsigned char>(Alphabet::normalize(static_cast<char>(character)))];
+	}
+	//Encrypt and decrypt every pair of characters once, in advance.
+	for(int index = 0;index < 2 * SIZE * SIZE;++index){
+		encrypted[index] = table[encrypted_position(index / 2 / SIZE,index / 2 % SIZE,index % 2)];
+		decrypted[index] = table[decrypted_position(index / 2 / SIZE,index / 2 % SIZE,index % 2)];
+	}
+}
+
+#endif /* TABLE_H */
@@ -0,0 +1,86 @@
+/*
+ * File: transform.h
+ * Author: Arthur Laks
+ *
+ * This file contains the rules for turning text into pairs of characters and encrypting or
+ * decrypting them, which are shared by the file mode of PlayFair and the service mode.  The
+ * text can be passed in any number of pieces, and the result does not depend on where it is
+ * divided.
+ */
+
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cctype>
+#include "table.h"
+
+template<typename Alphabet>
+class Transformer{
+public:
+	Transformer(const Playfair<Alphabet>& cipher,bool encrypt):
+			cipher(cipher),encrypt(encrypt),pending(0),has_pending(false){
+	}
+	//Skips whitespace in the input, and appends the encrypted or decrypted pairs of characters
+	//to the output.  A character left over at the end is paired with the first one of the next
+	//call.  Returns false if the input has a character that is not in the table, in which case
+	//the output is incomplete.
+	bool add(const char* input,std::size_t length,std::vector<char>& output){
+		for(std::size_t position = 0;position < length;++position){
+			char c_char = input[position];
+			//Skip whitespace, as reading the characters with >> did.
+			if(std::isspace(static_cast<unsigned char>(c_char))){
+				continue;
+			}
+			if(cipher.position(c_char) < 0){
+				return false;
+			}
+			if(has_pending){
+				add_pair(pending,c_char,output);
+			}else{
+				pending = c_char;
+			}
+			has_pending = !has_pending;
+		}
+		return true;
+	}
+	//Handles the last character if there is an odd number of them.  When encrypting, it is
+	//padded with 'X'.  A ciphertext always has an even number of characters, so when
+	//decrypting this returns false and the character is ignored.
+	bool finish(std::vector<char>& output){
+		if(!has_pending){
+			return true;
+		}
+		has_pending = false;
+		if(encrypt){
+			add_pair(pending,'X',output);
+			return true;
+		}
+		return false;
+	}
+private:
+	void add_pair(char a,char b,std::vector<char>& output) const{
+		//Compare the characters that are actually in the table, such as I for J.
+		a = Alphabet::normalize(a);
+		b = Alphabet::normalize(b);
+		//If the two letters are the same, replace one of them by an infrequently used letter.
+		//If they are already X them set one of them to Z.  The ciphertext never has a doubled
+		//pair, so this only applies to encryption.
+		if(encrypt && a == b){
+			b = b != 'X' ? 'X' : 'Z';
+		}
+		std::pair<char,char> transformed = encrypt ? cipher.encrypt(a,b) : cipher.decrypt(a,b);
+		output.push_back(transformed.first);
+		output.push_back(transformed.second);
+	}
+
+	const Playfair<Alphabet>& cipher;
+	bool encrypt;
+	//The first character of a pair whose second character was not read yet.
+	char pending;
+	bool has_pending;
+};
+
+#endif /* TRANSFORM_H */
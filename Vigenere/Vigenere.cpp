@@ -4,126 +4,221 @@
  *
  *  Created on: Mar 4, 2015
  * This program attempts to cryptanalyze a Vigenere cipher by trying every keyword length until
- * 50 and using the length with the index of coincidence closest to 0.065.  Based on the
- * keyword length, it guesses the keyword based on the technique from the textbook and decrypts
- * the text using on that keyword.
+ * a maximum (49 by default) and ranking the lengths by how close the index of coincidence is to
+ * 0.065 and by how many of the distances between repeated trigrams they divide (the Kasiski
+ * examination).  Based on the keyword length, it guesses the keyword based on the technique from
+ * the textbook and decrypts the text using on that keyword.  The keyword is then refined by hill
+ * climbing on the quadgram statistics of English.
  */
-#include <map>
 #include <iostream>
 #include <fstream>
 #include <iterator>
-#include <map>
 #include <vector>
 #include <string>
 #include <cmath>
 #include <sstream>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+
+#include "cryptanalysis.h"
+#include "batch.h"
+#include "parallel.h"
+#include "shift.h"
+#include "incremental.h"
 
-using std::map;
 using std::vector;
 using std::string;
 using std::cout;
 using std::endl;
 
-int shift_back(int,int);
-//This array stores the frequencies of the letters A, B, etc in English writing.
-double frequencies_in_english[] = {0.08167,0.01492,0.02782,0.04253,0.12702,0.02228,0.02015,0.06094,0.06966,
-		0.00153,0.00772,0.04025,0.02406,0.06749,0.07507,0.01929,0.00095,0.05987,0.06327,0.09056,
-		0.02758,0.00978,0.02360,0.00150,0.01974,0.00074};
-//The name of the file to be cryptanlayzed should be the only parameter.
+//Reads the letters of the file a block at a time, shifts them by the keyword, and writes them as
+//uppercase letters.
+void apply_keyword(LetterReader& reader,std::ostream& output,const string& keyword,bool decrypt);
+//Analyzes the file as it grows, and prints the keyword length and keyword whenever they change.
+//This never returns.
+void follow(LetterReader& reader,int max_length);
+//The number of letters that are read and decrypted at a time.
+const std::size_t BLOCK_SIZE = 1 << 20;
+
+//The name of the file to be cryptanlayzed should be the last parameter.  It can be preceded by
+//-m and the longest keyword length to try, by -t and the number of threads to use, and by -o
+//and the name of a file to write the plaintext to instead of printing it.  The quadgram counts
+//are read from english_quadgrams.txt in the directory of the program, or from the file after -q.
+//-b fft finds the keyword length from the autocorrelation of the ciphertext instead of the
+//index of coincidence of every length, which allows much longer keywords to be tried.
+//-l and a directory or a manifest file analyzes every file in it instead of a single file, and
+//writes a table of the results to the output file or to the standard output.
+//-e and a keyword encrypts the file with that keyword instead of analyzing it.
+//-f keeps analyzing the file as more ciphertext is appended to it, until it is interrupted.
 int main(int argc,char* args[]){
-	if(argc < 2){
-		std::cerr << "Usage: Vigenere filename" << endl;
+	int max_length = 49;
+	unsigned int num_threads = default_num_threads();
+	const char* filename = nullptr;
+	const char* output_filename = nullptr;
+	bool use_fft = false;
+	const char* batch_path = nullptr;
+	string encryption_keyword;
+	bool follow_file = false;
+	//Look for the quadgrams next to the executable by default.
+	string quadgram_filename = args[0];
+	quadgram_filename = quadgram_filename.substr(0,quadgram_filename.find_last_of('/') + 1) + "english_quadgrams.txt";
+	for(int arg = 1;arg < argc;++arg){
+		if(std::strcmp(args[arg],"-m") == 0 && arg + 1 < argc){
+			max_length = std::atoi(args[++arg]);
+		}else if(std::strcmp(args[arg],"-t") == 0 && arg + 1 < argc){
+			num_threads = std::max(std::atoi(args[++arg]),1);
+		}else if(std::strcmp(args[arg],"-o") == 0 && arg + 1 < argc){
+			output_filename = args[++arg];
+		}else if(std::strcmp(args[arg],"-q") == 0 && arg + 1 < argc){
+			quadgram_filename = args[++arg];
+		}else if(std::strcmp(args[arg],"-b") == 0 && arg + 1 < argc){
+			use_fft = std::strcmp(args[++arg],"fft") == 0;
+		}else if(std::strcmp(args[arg],"-l") == 0 && arg + 1 < argc){
+			batch_path = args[++arg];
+		}else if(std::strcmp(args[arg],"-e") == 0 && arg + 1 < argc){
+			encryption_keyword = args[++arg];
+		}else if(std::strcmp(args[arg],"-f") == 0){
+			follow_file = true;
+		}else{
+			filename = args[arg];
+		}
+	}
+	if((!filename && !batch_path) || max_length < 2){
+		std::cerr << "Usage: Vigenere [-m max_keyword_length] [-t threads] [-o output_filename] "
+				"[-q quadgram_filename] [-b ioc|fft] filename" << endl;
+		std::cerr << "       Vigenere [options] -l directory_or_manifest" << endl;
+		std::cerr << "       Vigenere -e keyword [-o output_filename] filename" << endl;
+		std::cerr << "       Vigenere -f [-m max_keyword_length] filename" << endl;
 		return 1;
 	}
-	//Read the cipher text from a text file.  This method eliminates all whitespace.
-	std::ifstream file(args[1]);
-	//The inner parentheses are to avoid the C++ most vexing parse.
-	string  cipher_text(std::istream_iterator<char>(file),(std::istream_iterator<char>()));
-
-	//Find the keyword length that makes the index of coincidence closest to 0.065.
-	double closest_ioc = 100;	 //The distance from 0.065 of the ioc obtained from the best
-	//keyword length that was tested.
-	int best_length = 0;	//The best keyword length tested so far.
-	string best_keyword;	//The keyword if the keyword length is best_length
-
-	//For every possible keyword length between 2 and 50.
-	for(int m = 2;m < 50;++m){
-		//Divide the text into substrings, and calculate their index of coincidence.
-		vector<string> substrings(m);
-		for(unsigned int counter = 0;counter < cipher_text.length();++counter){
-			substrings[counter % m].push_back(cipher_text[counter]);
-		}
-
-		//Calculate the ioc of each substring and find the letter of the keyword used for that
-		//substring.  Add up the ioc's in order to calculate their average.
-
-		double total_ioc = 0;
+	if(!encryption_keyword.empty()){
+		//Keep only the letters of the keyword, in uppercase.
 		string keyword;
-		for(auto c_string:substrings){
-			//Calculate the ioc of the substring.
-
-			//Count the frequencies of each letter.
-			map<char,int> frequencies;
-			for(auto iter = c_string.begin();iter < c_string.end();++iter){
-				++frequencies[*iter];
-			}
-			double ioc = 0;
-			for(auto pair:frequencies){
-				ioc += pair.second * (pair.second - 1);
+		for(char letter:encryption_keyword){
+			if(std::isalpha(static_cast<unsigned char>(letter))){
+				keyword.push_back(std::toupper(static_cast<unsigned char>(letter)));
 			}
-			ioc /= (c_string.size() * (c_string.size() - 1));
-
-			total_ioc += ioc;
-
-			//Find the keyword based on the formula from the textbook, page 35.
-			//Find the value of g that will cause mg to be closest to 0.065
-			double closest_approximation = 100;
-			int best_guess;		//The offset from the beginning of the alphabet of the best
-			//letter found so far.
-			//For each possible value of g.
-			for(int guess = 0;guess < 26;++guess){
-				double mg = 0;
-				for(int i = 0;i < 26;++i){
-					mg += frequencies_in_english[i] * frequencies[((i + guess) % 26) + 'A'] / c_string.length();
-				}
-				double distance_from_norm = std::abs(mg - 0.065);
-				if(distance_from_norm < closest_approximation){
-					closest_approximation = distance_from_norm;
-					best_guess = guess;
-				}
-			}
-			//Add that letter to the keyword.
-			keyword.push_back('A' + best_guess);
 		}
-
-		//Determine if this keyword length produces an ioc closer to 0.065 than the best keyword
-		//length found so far.
-		if(std::abs(total_ioc / m - 0.065) < closest_ioc){
-			closest_ioc = std::abs(total_ioc / m - 0.065);
-			best_length = m;
-			best_keyword = keyword;
+		LetterReader reader(filename);
+		if(keyword.empty() || !reader.is_open()){
+			std::cerr << (keyword.empty() ? "The keyword has no letters." : "File does not exist.") << endl;
+			return 2;
 		}
+		std::ofstream output_file;
+		if(output_filename){
+			output_file.open(output_filename);
+		}
+		apply_keyword(reader,output_filename ? output_file : cout,keyword,false);
+		return 0;
 	}
+	if(follow_file){
+		LetterReader reader(filename);
+		if(!reader.is_open()){
+			std::cerr << "File does not exist." << endl;
+			return 2;
+		}
+		follow(reader,max_length);
+	}
+	QuadgramTable quadgrams;
+	bool have_quadgrams = quadgrams.load(quadgram_filename);
+	if(!have_quadgrams){
+		std::cerr << "Could not read " << quadgram_filename << ", so the keyword will not be refined." << endl;
+	}
+	AnalysisOptions options;
+	options.max_length = max_length;
+	options.use_fft = use_fft;
+	options.num_threads = num_threads;
+	options.quadgrams = have_quadgrams ? &quadgrams : nullptr;
 
-	cout << "Here is the keyword length: " << best_length << endl;
-	cout << "Here is the keyword: " <<  best_keyword << endl;
+	if(batch_path){
+		vector<string> filenames = list_ciphertexts(batch_path);
+		if(filenames.empty()){
+			std::cerr << "There are no files to analyze in " << batch_path << "." << endl;
+			return 2;
+		}
+		std::ofstream output_file;
+		if(output_filename){
+			output_file.open(output_filename);
+		}
+		std::size_t num_succeeded = analyze_batch(filenames,options,num_threads,
+				output_filename ? output_file : cout);
+		std::cerr << "Analyzed " << num_succeeded << " of " << filenames.size() << " files." << endl;
+		return num_succeeded == filenames.size() ? 0 : 3;
+	}
 
+	//Read the cipher text from a text file a block at a time, so that it never has to be in
+	//memory all at once.  Whitespace and punctuation are eliminated.
+	LetterReader reader(filename);
+	if(!reader.is_open()){
+		std::cerr << "File does not exist." << endl;
+		return 2;
+	}
+	AnalysisResult result;
+	if(!analyze_ciphertext(reader,options,result)){
+		std::cerr << "The ciphertext is too short to analyze." << endl;
+		return 3;
+	}
+	if(use_fft){
+		cout << "Coincidence rate at the keyword length: " << result.coincidence_rate << endl;
+	}else{
+		cout << "Repeated trigrams: " << result.num_repeats << endl;
+	}
+	cout << "Here is the keyword length: " << result.guess.length << endl;
+	cout << "Here is the keyword: " <<  result.guess.keyword << endl;
+	if(have_quadgrams){
+		cout << "Here is the refined keyword: " << result.keyword << endl;
+	}
 	//Determine the plaintext by shifting every letter in the plaintext back by the correct
-	//number of positions.
-	std::stringstream plaintext;
-	for(unsigned  counter = 0;counter < cipher_text.length();++counter){
-		plaintext << static_cast<char>(shift_back(cipher_text[counter] - 'A',best_keyword[counter % best_length] - 'A') + 'A');
+	//number of positions.  Read the ciphertext again, and write each block of plaintext as soon
+	//as it is decrypted.
+	std::ofstream output_file;
+	if(output_filename){
+		output_file.open(output_filename);
+		cout << "Writing the plaintext to " << output_filename << endl;
+	}else{
+		cout << "Here is the plaintext:" << endl;
 	}
-
-	cout << "Here is the plaintext:" << endl << plaintext.str() << endl;
+	reader.rewind();
+	apply_keyword(reader,output_filename ? output_file : cout,result.keyword,true);
 
 	return 0;
 }
 
-//Performs subtraction mod 26, assuming that a and b are between 0 and 25.
-int shift_back(int a,int b){
-	if(a >= b)
-		return a - b;
-	else
-		return 26 + (a - b);
+void follow(LetterReader& reader,int max_length){
+	IncrementalAnalyzer analyzer(2,max_length + 1);
+	vector<char> letters(BLOCK_SIZE);
+	string keyword;
+	for(;;){
+		while(std::size_t count = reader.read(letters.data(),letters.size())){
+			analyzer.add(letters.data(),count);
+		}
+		LengthScore best = analyzer.best();
+		if(best.length && best.keyword != keyword){
+			keyword = best.keyword;
+			cout << "After " << analyzer.length() << " letters, the keyword length is " << best.length
+					<< " and the keyword is " << keyword << endl;
+		}
+		//Wait for more ciphertext.
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+		reader.resume();
+	}
+}
+
+void apply_keyword(LetterReader& reader,std::ostream& output,const string& keyword,bool decrypt){
+	vector<char> letters(BLOCK_SIZE);
+	unsigned long long position = 0;
+	while(std::size_t count = reader.read(letters.data(),letters.size())){
+		shift_by_keyword(letters.data(),count,keyword,position,decrypt);
+		for(std::size_t counter = 0;counter < count;++counter){
+			letters[counter] += 'A';
+		}
+		output.write(letters.data(),count);
+		position += count;
+	}
+	output << endl;
 }
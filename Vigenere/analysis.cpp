@@ -0,0 +1,162 @@
+/*
+ * analysis.cpp
+ *
+ *      Author: Arthur Laks
+ * Contains the implementations of the classes and functions used to find the keyword length and
+ * the keyword of a Vigenere cipher.
+ */
+#include "analysis.h"
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include "parallel.h"
+
+const double frequencies_in_english[ALPHABET_SIZE] = {0.08167,0.01492,0.02782,0.04253,0.12702,0.02228,0.02015,0.06094,0.06966,
+		0.00153,0.00772,0.04025,0.02406,0.06749,0.07507,0.01929,0.00095,0.05987,0.06327,0.09056,
+		0.02758,0.00978,0.02360,0.00150,0.01974,0.00074};
+
+namespace{
+//The text is added in blocks of this many letters.  Each block is counted for one keyword
+//length after another, so the block stays in the cache while the counts of only one length are
+//being updated.
+const std::size_t BLOCK_SIZE = 4096;
+}
+
+ColumnHistograms::ColumnHistograms(int min_length,int max_length):
+		minimum(min_length),maximum(max_length),next_column(max_length - min_length,0),text_length(0){
+	std::size_t total = 0;
+	for(int length = min_length;length < max_length;++length){
+		offsets.push_back(total);
+		total += length * ALPHABET_SIZE;
+	}
+	table.assign(total,0);
+}
+
+void ColumnHistograms::add(const char* letters,std::size_t count,unsigned int num_threads){
+	//It takes the same amount of time to count the letters for every length, so give each
+	//thread every num_threads-th length.
+	std::vector<std::thread> threads;
+	for(unsigned int thread = 1;thread < num_threads;++thread){
+		threads.push_back(std::thread(&ColumnHistograms::add_lengths,this,letters,count,
+				minimum + thread,num_threads));
+	}
+	add_lengths(letters,count,minimum,num_threads);
+	for(auto& c_thread:threads){
+		c_thread.join();
+	}
+	text_length += count;
+}
+
+void ColumnHistograms::add_lengths(const char* letters,std::size_t count,int first,int step){
+	for(std::size_t block = 0;block < count;block += BLOCK_SIZE){
+		std::size_t block_end = std::min(count,block + BLOCK_SIZE);
+		for(int length = first;length < maximum;length += step){
+			//Keep track of the column instead of calculating the position mod length.
+			unsigned int* columns = &table[offsets[length - minimum]];
+			int column = next_column[length - minimum];
+			for(std::size_t position = block;position < block_end;++position){
+				++columns[column * ALPHABET_SIZE + letters[position]];
+				if(++column == length){
+					column = 0;
+				}
+			}
+			next_column[length - minimum] = column;
+		}
+	}
+}
+
+double index_of_coincidence(const unsigned int* counts,unsigned long length){
+	double ioc = 0;
+	for(int letter = 0;letter < ALPHABET_SIZE;++letter){
+		ioc += static_cast<double>(counts[letter]) * (counts[letter] - 1.0);
+	}
+	return ioc / (static_cast<double>(length) * (length - 1.0));
+}
+
+//Uses the formula from the textbook, page 35.  Finds the value of g that will cause mg to be
+//closest to 0.065.
+int best_shift(const unsigned int* counts,unsigned long length){
+	double closest_approximation = 100;
+	int best_guess = 0;	//The offset from the beginning of the alphabet of the best
+	//letter found so far.
+	//For each possible value of g.
+	for(int guess = 0;guess < ALPHABET_SIZE;++guess){
+		double mg = 0;
+		for(int i = 0;i < ALPHABET_SIZE;++i){
+			mg += frequencies_in_english[i] * counts[(i + guess) % ALPHABET_SIZE] / static_cast<double>(length);
+		}
+		double distance_from_norm = std::abs(mg - 0.065);
+		if(distance_from_norm < closest_approximation){
+			closest_approximation = distance_from_norm;
+			best_guess = guess;
+		}
+	}
+	return best_guess;
+}
+
+LengthScore score_length(const ColumnHistograms& histograms,int length){
+	//Calculate the ioc of each column and find the letter of the keyword used for that
+	//column.  Add up the ioc's in order to calculate their average.
+	LengthScore retval;
+	retval.length = length;
+	double total_ioc = 0;
+	for(int column = 0;column < length;++column){
+		const unsigned int* counts = histograms.counts(length,column);
+		unsigned long column_length = histograms.column_length(length,column);
+		total_ioc += index_of_coincidence(counts,column_length);
+		retval.keyword.push_back('A' + best_shift(counts,column_length));
+	}
+	retval.average_ioc = total_ioc / length;
+	return retval;
+}
+
+std::vector<LengthScore> score_all_lengths(const ColumnHistograms& histograms,unsigned int num_threads){
+	//List every column of every length, so that the threads can take them one at a time.
+	std::vector<std::pair<int,int> > columns;
+	for(int length = histograms.min_length();length < histograms.max_length();++length){
+		for(int column = 0;column < length;++column){
+			columns.push_back(std::make_pair(length,column));
+		}
+	}
+	std::vector<double> iocs(columns.size());
+	std::vector<int> shifts(columns.size());
+	parallel_for(columns.size(),num_threads,[&](std::size_t index){
+		const unsigned int* counts = histograms.counts(columns[index].first,columns[index].second);
+		unsigned long column_length = histograms.column_length(columns[index].first,columns[index].second);
+		iocs[index] = index_of_coincidence(counts,column_length);
+		shifts[index] = best_shift(counts,column_length);
+	});
+
+	//Combine the columns of each length in order, so that the sums are the same as they would
+	//be with one thread.
+	std::vector<LengthScore> scores;
+	std::size_t index = 0;
+	for(int length = histograms.min_length();length < histograms.max_length();++length){
+		LengthScore score;
+		score.length = length;
+		double total_ioc = 0;
+		for(int column = 0;column < length;++column,++index){
+			total_ioc += iocs[index];
+			score.keyword.push_back('A' + shifts[index]);
+		}
+		score.average_ioc = total_ioc / length;
+		scores.push_back(score);
+	}
+	return scores;
+}
+
+LengthScore find_best_length(const ColumnHistograms& histograms,unsigned int num_threads){
+	//The distance from 0.065 of the ioc obtained from the best keyword length that was tested.
+	double closest_ioc = 100;
+	LengthScore best;
+	best.length = 0;
+	for(const LengthScore& score:score_all_lengths(histograms,num_threads)){
+		//Determine if this keyword length produces an ioc closer to 0.065 than the best keyword
+		//length found so far.
+		if(std::abs(score.average_ioc - 0.065) < closest_ioc){
+			closest_ioc = std::abs(score.average_ioc - 0.065);
+			best = score;
+		}
+	}
+	return best;
+}
@@ -0,0 +1,97 @@
+/*
+ * analysis.h
+ *
+ *      Author: Arthur Laks
+ *  Contains the declarations of the classes and functions used to find the keyword length and
+ *  the keyword of a Vigenere cipher from the letter frequencies of the ciphertext.
+ */
+
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+//The number of letters in the alphabet.
+const int ALPHABET_SIZE = 26;
+
+//This array stores the frequencies of the letters A, B, etc in English writing.
+extern const double frequencies_in_english[ALPHABET_SIZE];
+
+//Counts the letters of every column of the ciphertext, for every keyword length in a range.  If
+//the keyword length is m, column j consists of the letters at the positions that are j mod m.
+//The counts are stored in a single flat array, with ALPHABET_SIZE counts per column, so that
+//adding text does not allocate any memory.
+class ColumnHistograms{
+public:
+	//Counts the columns for the keyword lengths from min_length up to, but not including,
+	//max_length.
+	ColumnHistograms(int min_length,int max_length);
+
+	//Appends letters to the text.  Each letter is a number between 0 and 25.  The keyword
+	//lengths are divided between the threads, so that each thread reads the letters once and
+	//updates its own part of the table.
+	void add(const char* letters,std::size_t count,unsigned int num_threads = 1);
+
+	//Returns the ALPHABET_SIZE counts of the letters in a column.
+	const unsigned int* counts(int length,int column) const{
+		return &table[offsets[length - minimum] + column * ALPHABET_SIZE];
+	}
+	//Returns the number of letters in a column.
+	unsigned long column_length(int length,int column) const{
+		return text_length / length + (static_cast<unsigned long>(column) < text_length % length);
+	}
+	int min_length() const{
+		return minimum;
+	}
+	int max_length() const{
+		return maximum;
+	}
+	unsigned long length() const{
+		return text_length;
+	}
+private:
+	//Counts the letters for every step-th keyword length, starting from first.
+	void add_lengths(const char* letters,std::size_t count,int first,int step);
+
+	int minimum,maximum;
+	//The index in table of the first count of the first column of each keyword length.
+	std::vector<std::size_t> offsets;
+	std::vector<unsigned int> table;
+	//The column that the next letter will go into, for each keyword length.
+	std::vector<int> next_column;
+	unsigned long text_length;
+};
+
+//The result of analyzing the ciphertext under the assumption that the keyword has a certain
+//length.
+struct LengthScore{
+	int length;
+	//The average index of coincidence of the columns.
+	double average_ioc;
+	//The best guess of the keyword.
+	std::string keyword;
+};
+
+//Calculates the index of coincidence of a column from its letter counts.
+double index_of_coincidence(const unsigned int* counts,unsigned long length);
+
+//Finds the letter of the keyword that was used to encrypt a column, from its letter counts.
+//Returns its offset from the beginning of the alphabet.
+int best_shift(const unsigned int* counts,unsigned long length);
+
+//Calculates the average index of coincidence of the columns and guesses the keyword, for a
+//keyword of the specified length.
+LengthScore score_length(const ColumnHistograms&,int length);
+
+//Scores every keyword length in the histograms, in order of length.  The columns of all of the
+//lengths are scored in parallel.
+std::vector<LengthScore> score_all_lengths(const ColumnHistograms&,unsigned int num_threads = 1);
+
+//Scores every keyword length in the histograms and returns the one whose average index of
+//coincidence is closest to 0.065.  If there is a tie the shortest one is returned, regardless
+//of the number of threads.
+LengthScore find_best_length(const ColumnHistograms&,unsigned int num_threads = 1);
+
+#endif /* ANALYSIS_H */
@@ -0,0 +1,165 @@
+/*
+ * autocorrelation.cpp
+ *
+ *      Author: Arthur Laks
+ * Contains the implementation of the Autocorrelation class.
+ */
+#include "autocorrelation.h"
+#include <complex>
+#include <cmath>
+#include <algorithm>
+#include "analysis.h"
+
+typedef Autocorrelation::Complex Complex;
+
+namespace{
+//The smallest size of the transforms.
+const std::size_t MIN_TRANSFORM_SIZE = 1 << 16;
+
+//Replaces the values with their discrete Fourier transform, or with the inverse transform
+//multiplied by the size if inverse is true.  The size must be a power of 2.
+void fft(std::vector<Complex>& values,bool inverse){
+	std::size_t size = values.size();
+	//Put the values in bit-reversed order.
+	for(std::size_t i = 1,j = 0;i < size;++i){
+		std::size_t bit = size >> 1;
+		for(;j & bit;bit >>= 1){
+			j ^= bit;
+		}
+		j ^= bit;
+		if(i < j){
+			std::swap(values[i],values[j]);
+		}
+	}
+	const double PI = std::acos(-1.0);
+	for(std::size_t half = 1;half < size;half <<= 1){
+		//The twiddle factors of this pass.  The products are written out instead of using the
+		//operators of std::complex, which check for infinities and are much slower.
+		double angle = (inverse ? PI : -PI) / half;
+		std::vector<Complex> twiddles(half);
+		for(std::size_t offset = 0;offset < half;++offset){
+			twiddles[offset] = std::polar(1.0,angle * offset);
+		}
+		for(std::size_t start = 0;start < size;start += 2 * half){
+			for(std::size_t offset = 0;offset < half;++offset){
+				Complex even = values[start + offset];
+				Complex odd = values[start + offset + half];
+				const Complex& twiddle = twiddles[offset];
+				Complex product(odd.real() * twiddle.real() - odd.imag() * twiddle.imag(),
+						odd.real() * twiddle.imag() + odd.imag() * twiddle.real());
+				values[start + offset] = Complex(even.real() + product.real(),even.imag() + product.imag());
+				values[start + offset + half] = Complex(even.real() - product.real(),even.imag() - product.imag());
+			}
+		}
+	}
+}
+}
+
+Autocorrelation::Autocorrelation(int max_shift):maximum(max_shift),coincidences(max_shift + 1,0),
+		pending(0),text_length(0){
+	//Each transform holds the last maximum letters of the previous segment and the new segment,
+	//and maximum more positions of padding.  Make the transform large enough
+	//that most of it is new letters, and make the segments fill it exactly.
+	transform_size = MIN_TRANSFORM_SIZE;
+	while(transform_size < 4 * static_cast<std::size_t>(maximum)){
+		transform_size <<= 1;
+	}
+	segment_size = transform_size - 2 * maximum;
+}
+
+void Autocorrelation::add(const char* letters,std::size_t count){
+	window.insert(window.end(),letters,letters + count);
+	text_length += count;
+	while(window.size() - pending >= segment_size){
+		add_segment(pending + segment_size);
+	}
+	//Discard the letters that are too far back to be correlated with the rest.
+	std::size_t unused = pending - std::min<std::size_t>(maximum,pending);
+	window.erase(window.begin(),window.begin() + unused);
+	pending -= unused;
+}
+
+void Autocorrelation::finish(){
+	if(pending < window.size()){
+		add_segment(window.size());
+	}
+}
+
+void Autocorrelation::add_segment(std::size_t end){
+	std::size_t begin = pending - std::min<std::size_t>(maximum,pending);
+	std::size_t start = pending - begin;
+	std::size_t length = end - begin;
+	std::size_t size = transform_size;
+	//The last segment may be shorter.
+	while(size / 2 >= length + maximum){
+		size >>= 1;
+	}
+	//The transform is linear, so the sum of the correlations of the letters is the correlation
+	//of the sums.  Two letters are put into the real and imaginary parts of each transform, and
+	//the real part of the result is the sum of both of their correlations.  The later letter of
+	//each pair is from start on, and the earlier one is up to maximum letters before it; the
+	//padding prevents the correlation from wrapping around.
+	sum.assign(size,0);
+	earlier.resize(size);
+	later.resize(size);
+	for(int letter = 0;letter < ALPHABET_SIZE;letter += 2){
+		std::fill(earlier.begin() + length,earlier.end(),0);
+		for(std::size_t position = 0;position < length;++position){
+			char c_letter = window[begin + position];
+			earlier[position] = Complex(c_letter == letter,c_letter == letter + 1);
+		}
+		std::fill(later.begin(),later.begin() + start,0);
+		std::copy(earlier.begin() + start,earlier.end(),later.begin() + start);
+		fft(earlier,false);
+		fft(later,false);
+		for(std::size_t frequency = 0;frequency < size;++frequency){
+			const Complex& a = later[frequency];
+			const Complex& b = earlier[frequency];
+			sum[frequency] += Complex(a.real() * b.real() + a.imag() * b.imag(),a.imag() * b.real() - a.real() * b.imag());
+		}
+	}
+	fft(sum,true);
+	for(int shift = 1;shift <= maximum;++shift){
+		coincidences[shift] += static_cast<unsigned long long>(std::floor(sum[shift].real() / size + 0.5));
+	}
+	pending = end;
+}
+
+double Autocorrelation::coincidence_rate(int shift) const{
+	return text_length > static_cast<unsigned long long>(shift) ?
+			static_cast<double>(coincidences[shift]) / (text_length - shift) : 0;
+}
+
+std::vector<double> Autocorrelation::score_lengths(int min_length,int max_length) const{
+	int num_shifts = static_cast<int>(std::min<unsigned long long>(maximum,text_length > 0 ? text_length - 1 : 0));
+	double total_rate = 0;
+	for(int shift = 1;shift <= num_shifts;++shift){
+		total_rate += coincidence_rate(shift);
+	}
+	std::vector<double> scores;
+	for(int length = min_length;length < max_length;++length){
+		double multiples_rate = 0;
+		int num_multiples = 0;
+		for(int shift = length;shift <= num_shifts;shift += length,++num_multiples){
+			multiples_rate += coincidence_rate(shift);
+		}
+		if(num_multiples == 0 || num_multiples == num_shifts){
+			//The text is too short to say anything about this length.
+			scores.push_back(-1);
+		}else{
+			//The average at the multiples of a shorter length is more reliable, because there
+			//are more of them.
+			double difference = multiples_rate / num_multiples -
+					(total_rate - multiples_rate) / (num_shifts - num_multiples);
+			scores.push_back(difference * std::sqrt(static_cast<double>(num_multiples)));
+		}
+	}
+	return scores;
+}
+
+int Autocorrelation::best_length(int min_length,int max_length) const{
+	std::vector<double> scores = score_lengths(min_length,max_length);
+	//If there is a tie the shortest length is used.
+	std::size_t best = std::max_element(scores.begin(),scores.end()) - scores.begin();
+	return best < scores.size() && scores[best] > -1 ? min_length + best : 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * autocorrelation.h
+ *
+ *      Author: Arthur Laks
+ *  Contains the declaration of the Autocorrelation class, which finds the keyword length of a
+ *  Vigenere cipher from how often the ciphertext coincides with itself shifted by each amount.
+ */
+
+#ifndef AUTOCORRELATION_H
+#define AUTOCORRELATION_H
+
+#include <vector>
+#include <cstddef>
+#include <complex>
+
+//Counts, for every shift s up to a maximum, the number of positions i where letter i of the
+//text is the same as letter i + s.  If s is a multiple of the keyword length, both letters were
+//encrypted with the same letter of the keyword, so they coincide about as often as two letters
+//of English (6.5% of the time) instead of 3.8% of the time.
+//
+//The count at every shift is the sum over the letters of the autocorrelation of the sequence
+//that is 1 where the text has that letter, which is calculated for all of the shifts at once
+//with fast Fourier transforms.  The text is added a segment at a time, and each segment is
+//correlated with itself and the end of the previous one.
+class Autocorrelation{
+public:
+	typedef std::complex<double> Complex;
+
+	explicit Autocorrelation(int max_shift);
+
+	//Appends letters to the text.  Each letter is a number between 0 and 25.
+	void add(const char* letters,std::size_t count);
+	//Correlates the letters that were added since the last full segment.  This has to be
+	//called after the last letters are added, before the results are used.
+	void finish();
+
+	//Returns the fraction of the positions at which the text coincides with itself shifted by
+	//shift letters, where shift is between 1 and the maximum shift.
+	double coincidence_rate(int shift) const;
+
+	//Scores every keyword length from min_length up to, but not including, max_length, by the
+	//average coincidence rate at its multiples minus the average at the other shifts, weighted by
+	//the square root of the number of multiples.  A divisor of the real length loses at the
+	//shifts that are not multiples of the real length, and a multiple of it has fewer shifts to
+	//be averaged, so the real length scores highest.
+	std::vector<double> score_lengths(int min_length,int max_length) const;
+
+	//Returns the length with the highest score, or 0 if the text is too short.
+	int best_length(int min_length,int max_length) const;
+
+	int max_shift() const{
+		return maximum;
+	}
+private:
+	//Adds the coincidences between the letters of the window from the first one that was not
+	//correlated yet up to end and the letters up to maximum positions before them.
+	void add_segment(std::size_t end);
+
+	int maximum;
+	//The number of coincidences at each shift.
+	std::vector<unsigned long long> coincidences;
+	//The last maximum letters that were correlated, followed by the letters that were not
+	//correlated yet.
+	std::vector<char> window;
+	//The position in the window of the first letter that was not correlated yet.
+	std::size_t pending;
+	//The number of new letters that are correlated at a time, and the size of the transforms.
+	std::size_t segment_size,transform_size;
+	//The transforms, which are kept between segments to avoid allocating them again.
+	std::vector<Complex> sum,earlier,later;
+	unsigned long long text_length;
+};
+
+#endif /* AUTOCORRELATION_H */
@@ -0,0 +1,96 @@
+/*
+ * batch.cpp
+ *
+ *      Author: Arthur Laks
+ * Contains the implementations of the functions that analyze many ciphertext files.
+ */
+#include "batch.h"
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "parallel.h"
+
+using std::vector;
+using std::string;
+
+namespace{
+bool is_directory(const string& path){
+	struct stat status;
+	return stat(path.c_str(),&status) == 0 && S_ISDIR(status.st_mode);
+}
+
+bool is_regular_file(const string& path){
+	struct stat status;
+	return stat(path.c_str(),&status) == 0 && S_ISREG(status.st_mode);
+}
+}
+
+vector<string> list_ciphertexts(const string& path){
+	vector<string> filenames;
+	if(is_directory(path)){
+		DIR* directory = opendir(path.c_str());
+		if(!directory){
+			return filenames;
+		}
+		while(dirent* entry = readdir(directory)){
+			string filename = path + "/" + entry->d_name;
+			if(entry->d_name[0] != '.' && is_regular_file(filename)){
+				filenames.push_back(filename);
+			}
+		}
+		closedir(directory);
+		std::sort(filenames.begin(),filenames.end());
+		return filenames;
+	}
+	std::ifstream manifest(path.c_str());
+	string directory = path.substr(0,path.find_last_of('/') + 1);
+	string line;
+	while(std::getline(manifest,line)){
+		//Remove the whitespace around the name.
+		line.erase(0,line.find_first_not_of(" \t\r"));
+		line.erase(line.find_last_not_of(" \t\r") + 1);
+		if(line.empty() || line[0] == '#'){
+			continue;
+		}
+		filenames.push_back(line[0] == '/' ? line : directory + line);
+	}
+	return filenames;
+}
+
+std::size_t analyze_batch(const vector<string>& filenames,const AnalysisOptions& options,
+		unsigned int num_threads,std::ostream& output){
+	struct FileResult{
+		bool succeeded;
+		AnalysisResult analysis;
+		long long milliseconds;
+	};
+	vector<FileResult> results(filenames.size());
+	//The files are analyzed in parallel, so each analysis uses one thread.
+	AnalysisOptions file_options = options;
+	file_options.num_threads = 1;
+	parallel_for_stealing(filenames.size(),num_threads,[&](std::size_t index){
+		auto start = std::chrono::steady_clock::now();
+		LetterReader reader(filenames[index].c_str());
+		results[index].succeeded = reader.is_open() && analyze_ciphertext(reader,file_options,results[index].analysis);
+		results[index].milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+				std::chrono::steady_clock::now() - start).count();
+	});
+
+	std::size_t num_succeeded = 0;
+	output << "file\tkeyword_length\tkeyword\tioc\tfitness\tmilliseconds\n";
+	for(std::size_t index = 0;index < filenames.size();++index){
+		const FileResult& result = results[index];
+		output << filenames[index] << '\t';
+		if(result.succeeded){
+			output << result.analysis.keyword.length() << '\t' << result.analysis.keyword << '\t'
+					<< result.analysis.guess.average_ioc << '\t' << result.analysis.fitness;
+			++num_succeeded;
+		}else{
+			output << "0\t-\t0\t0";
+		}
+		output << '\t' << result.milliseconds << '\n';
+	}
+	return num_succeeded;
+}
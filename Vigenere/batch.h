@@ -0,0 +1,32 @@
+/*
+ * batch.h
+ *
+ *      Author: Arthur Laks
+ *  Contains the declarations of the functions that analyze many ciphertext files in one process.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include "cryptanalysis.h"
+
+//Returns the files to analyze.  If the path is a directory, they are the regular files in it,
+//in alphabetical order.  Otherwise it is a manifest with one filename per line; blank lines and
+//lines that start with '#' are skipped, and relative names are relative to the directory of the
+//manifest.  Returns an empty list if the path cannot be read.
+std::vector<std::string> list_ciphertexts(const std::string& path);
+
+//Analyzes the files on num_threads threads, one file per thread at a time, and writes a line of
+//tab-separated results for each file to the output, in the order of the list.  The columns are
+//the filename, the keyword length, the keyword, the average index of coincidence of the columns
+//for the length that was guessed before refinement, the quadgram fitness of the decryption and
+//the number of milliseconds the analysis took.  A file that could not be read or analyzed has a
+//keyword length of 0 and a keyword of "-".  Returns the number of files that were analyzed
+//successfully.
+std::size_t analyze_batch(const std::vector<std::string>& filenames,const AnalysisOptions& options,
+		unsigned int num_threads,std::ostream& output);
+
+#endif /* BATCH_H */
@@ -0,0 +1,89 @@
+/*
+ * cryptanalysis.cpp
+ *
+ *      Author: Arthur Laks
+ * Contains the implementation of the function that finds the keyword of a Vigenere ciphertext.
+ */
+#include "cryptanalysis.h"
+#include <vector>
+#include <algorithm>
+#include "kasiski.h"
+#include "autocorrelation.h"
+#include "shift.h"
+
+using std::vector;
+
+namespace{
+//The number of letters that are read and processed at a time.
+const std::size_t BLOCK_SIZE = 1 << 20;
+//The number of letters from the beginning of the ciphertext that are used to refine the keyword.
+const std::size_t SAMPLE_SIZE = 1 << 17;
+//The length of the repeated n-grams that the Kasiski examination looks for.
+const int KASISKI_NGRAM_LENGTH = 3;
+//The autocorrelation is calculated for shifts up to this many times the longest keyword length,
+//so that every length has several multiples to be scored on.
+const int AUTOCORRELATION_MULTIPLES = 4;
+}
+
+bool analyze_ciphertext(LetterReader& reader,const AnalysisOptions& options,AnalysisResult& result){
+	vector<char> letters(BLOCK_SIZE);
+	//Keep the beginning of the text for refining the keyword.
+	vector<char> sample;
+	LengthScore& best = result.guess;
+	result.num_repeats = 0;
+	result.coincidence_rate = 0;
+	result.fitness = 0;
+	if(options.use_fft){
+		//Find the keyword length from the autocorrelation, and then read the text again to
+		//count the letters of the columns of that length only.
+		Autocorrelation autocorrelation(AUTOCORRELATION_MULTIPLES * options.max_length);
+		while(std::size_t count = reader.read(letters.data(),letters.size())){
+			autocorrelation.add(letters.data(),count);
+			std::size_t sample_count = std::min(count,SAMPLE_SIZE - sample.size());
+			sample.insert(sample.end(),letters.begin(),letters.begin() + sample_count);
+		}
+		autocorrelation.finish();
+		best.length = autocorrelation.best_length(2,options.max_length + 1);
+		if(best.length == 0){
+			return false;
+		}
+		ColumnHistograms histograms(best.length,best.length + 1);
+		reader.rewind();
+		while(std::size_t count = reader.read(letters.data(),letters.size())){
+			histograms.add(letters.data(),count);
+		}
+		best = score_length(histograms,best.length);
+		result.coincidence_rate = autocorrelation.coincidence_rate(best.length);
+	}else{
+		//Count the letters of every column for every possible keyword length between 2 and
+		//max_length, and find the keyword length that makes the index of coincidence closest to
+		//0.065.
+		ColumnHistograms histograms(2,options.max_length + 1);
+		while(std::size_t count = reader.read(letters.data(),letters.size())){
+			histograms.add(letters.data(),count,options.num_threads);
+			std::size_t sample_count = std::min(count,SAMPLE_SIZE - sample.size());
+			sample.insert(sample.end(),letters.begin(),letters.begin() + sample_count);
+		}
+		//Combine the ranking by the index of coincidence with the Kasiski examination of the
+		//beginning of the text.
+		KasiskiResult kasiski = kasiski_examination(sample,KASISKI_NGRAM_LENGTH,2,options.max_length + 1);
+		best = merge_rankings(score_all_lengths(histograms,options.num_threads),kasiski);
+		result.num_repeats = kasiski.num_repeats;
+		if(histograms.length() < 2){
+			return false;
+		}
+	}
+	result.keyword = best.keyword;
+	if(!options.quadgrams){
+		return true;
+	}
+
+	//Correct the keyword based on how much the decryption looks like English.  This also
+	//catches keywords that are a repetition of the real one.
+	result.keyword = refine_keyword(*options.quadgrams,sample,best.keyword);
+	shift_by_keyword(sample.data(),sample.size(),result.keyword,0,true);
+	if(sample.size() >= 4){
+		result.fitness = options.quadgrams->score_text(sample.data(),sample.size()) / (sample.size() - 3);
+	}
+	return true;
+}
@@ -0,0 +1,49 @@
+/*
+ * cryptanalysis.h
+ *
+ *      Author: Arthur Laks
+ *  Contains the declaration of the function that finds the keyword of a Vigenere ciphertext
+ *  file, which is shared by the analysis of a single file and of a batch of files.
+ */
+
+#ifndef CRYPTANALYSIS_H
+#define CRYPTANALYSIS_H
+
+#include <string>
+#include <cstddef>
+#include "analysis.h"
+#include "input.h"
+#include "quadgrams.h"
+
+//The settings that control how a ciphertext is analyzed.
+struct AnalysisOptions{
+	//The longest keyword length to try.
+	int max_length;
+	//Whether to find the keyword length from the autocorrelation instead of the index of
+	//coincidence and the Kasiski examination.
+	bool use_fft;
+	unsigned int num_threads;
+	//The statistics used to refine the keyword, or null if it should not be refined.
+	const QuadgramTable* quadgrams;
+};
+
+//The result of analyzing a ciphertext.
+struct AnalysisResult{
+	//The keyword length and keyword chosen from the letter frequencies.
+	LengthScore guess;
+	//The keyword after refinement, or the guess if it was not refined.
+	std::string keyword;
+	//The number of repeated trigrams found by the Kasiski examination, if it was used.
+	std::size_t num_repeats;
+	//The coincidence rate at the keyword length, if the autocorrelation was used.
+	double coincidence_rate;
+	//The average quadgram score of the decryption of the beginning of the text with the final
+	//keyword, or 0 if there are no quadgram statistics.
+	double fitness;
+};
+
+//Reads the ciphertext from the reader and finds its keyword.  The reader is left at the end of
+//the file.  Returns false if the text is too short to analyze.
+bool analyze_ciphertext(LetterReader& reader,const AnalysisOptions& options,AnalysisResult& result);
+
+#endif /* CRYPTANALYSIS_H */
@@ -0,0 +1,85 @@
+/*
+ * incremental.cpp
+ *
+ *      Author: Arthur Laks
+ * Contains the implementation of the IncrementalAnalyzer class.
+ */
+#include "incremental.h"
+#include <cmath>
+
+IncrementalAnalyzer::IncrementalAnalyzer(int min_length,int max_length):
+		minimum(min_length),maximum(max_length),next_column(max_length - min_length,0),text_length(0){
+	std::size_t total = 0;
+	for(int length = min_length;length < max_length;++length){
+		offsets.push_back(total);
+		total += length;
+	}
+	Column empty = Column();
+	columns.assign(total,empty);
+	//mg for the guess g is the sum of the frequency of letter i times the count of letter
+	//i + g, so a new letter c adds the frequency of c - g.
+	for(int letter = 0;letter < ALPHABET_SIZE;++letter){
+		for(int guess = 0;guess < ALPHABET_SIZE;++guess){
+			contributions[letter][guess] = frequencies_in_english[(letter - guess + ALPHABET_SIZE) % ALPHABET_SIZE];
+		}
+	}
+}
+
+void IncrementalAnalyzer::add(const char* letters,std::size_t count){
+	for(int length = minimum;length < maximum;++length){
+		Column* length_columns = &columns[offsets[length - minimum]];
+		int column = next_column[length - minimum];
+		for(std::size_t position = 0;position < count;++position){
+			Column& c_column = length_columns[column];
+			int letter = letters[position];
+			c_column.pairs += 2ULL * c_column.counts[letter]++;
+			for(int guess = 0;guess < ALPHABET_SIZE;++guess){
+				c_column.mg[guess] += contributions[letter][guess];
+			}
+			if(++column == length){
+				column = 0;
+			}
+		}
+		next_column[length - minimum] = column;
+	}
+	text_length += count;
+}
+
+LengthScore IncrementalAnalyzer::score(int length) const{
+	LengthScore retval;
+	retval.length = length;
+	double total_ioc = 0;
+	const Column* length_columns = &columns[offsets[length - minimum]];
+	for(int column = 0;column < length;++column){
+		const Column& c_column = length_columns[column];
+		double column_length = text_length / length + (static_cast<unsigned long>(column) < text_length % length);
+		total_ioc += c_column.pairs / (column_length * (column_length - 1.0));
+		//Find the value of g that will cause mg to be closest to 0.065.
+		double closest_approximation = 100;
+		int best_guess = 0;
+		for(int guess = 0;guess < ALPHABET_SIZE;++guess){
+			double distance_from_norm = std::abs(c_column.mg[guess] / column_length - 0.065);
+			if(distance_from_norm < closest_approximation){
+				closest_approximation = distance_from_norm;
+				best_guess = guess;
+			}
+		}
+		retval.keyword.push_back('A' + best_guess);
+	}
+	retval.average_ioc = total_ioc / length;
+	return retval;
+}
+
+LengthScore IncrementalAnalyzer::best() const{
+	double closest_ioc = 100;
+	LengthScore best;
+	best.length = 0;
+	for(int length = minimum;length < maximum;++length){
+		LengthScore c_score = score(length);
+		if(std::abs(c_score.average_ioc - 0.065) < closest_ioc){
+			closest_ioc = std::abs(c_score.average_ioc - 0.065);
+			best = c_score;
+		}
+	}
+	return best;
+}
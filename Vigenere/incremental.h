@@ -0,0 +1,64 @@
+/*
+ * incremental.h
+ *
+ *      Author: Arthur Laks
+ *  Contains the declaration of the IncrementalAnalyzer class, which keeps track of the best
+ *  keyword length and keyword of a ciphertext that is still arriving.
+ */
+
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <vector>
+#include <cstddef>
+#include "analysis.h"
+
+//Counts the letters of every column for every keyword length in a range, like ColumnHistograms,
+//and also keeps the sums that the index of coincidence and the best shift of each column are
+//calculated from, so that they do not have to be recalculated from the counts.  Adding a letter
+//that already appeared n times to a column increases the sum of the n(n - 1) terms of the index
+//of coincidence by 2n, and increases the sum of mg for each guess of the shift by the frequency
+//in English of the letter that it would decrypt to.  Each letter takes a constant amount of work
+//for each keyword length, and the best length and keyword can be found at any moment without
+//looking at the text again.
+class IncrementalAnalyzer{
+public:
+	//Analyzes the keyword lengths from min_length up to, but not including, max_length.
+	IncrementalAnalyzer(int min_length,int max_length);
+
+	//Appends letters to the text.  Each letter is a number between 0 and 25.
+	void add(const char* letters,std::size_t count);
+
+	//Returns the average index of coincidence of the columns and the best guess of the keyword
+	//for a keyword of the specified length.
+	LengthScore score(int length) const;
+	//Returns the score of the length whose average index of coincidence is closest to 0.065,
+	//or a length of 0 if there are not enough letters yet.  If there is a tie the shortest one
+	//is returned.
+	LengthScore best() const;
+
+	unsigned long length() const{
+		return text_length;
+	}
+private:
+	//The sums that are kept for each column.
+	struct Column{
+		unsigned int counts[ALPHABET_SIZE];
+		//The sum of count * (count - 1) over the letters.
+		unsigned long long pairs;
+		//mg for each guess of the shift, multiplied by the length of the column.
+		double mg[ALPHABET_SIZE];
+	};
+	int minimum,maximum;
+	//The index of the first column of each keyword length.
+	std::vector<std::size_t> offsets;
+	std::vector<Column> columns;
+	//The column that the next letter will go into, for each keyword length.
+	std::vector<int> next_column;
+	unsigned long text_length;
+	//contributions[letter][guess] is the frequency in English of the letter that the letter
+	//decrypts to if the shift is guess.
+	double contributions[ALPHABET_SIZE][ALPHABET_SIZE];
+};
+
+#endif /* INCREMENTAL_H */
@@ -0,0 +1,42 @@
+/*
+ * input.cpp
+ *
+ *      Author: Arthur Laks
+ * Contains the implementation of the LetterReader class.
+ */
+#include "input.h"
+
+LetterReader::LetterReader(const char* filename):file(filename,std::ios::in | std::ios::binary){
+}
+
+std::size_t LetterReader::read(char* letters,std::size_t capacity){
+	std::size_t count = 0;
+	//Keep reading until at least one letter was found, in case a whole block has no letters.
+	while(count == 0 && file){
+		//There can't be more letters than characters, so reading capacity characters will not
+		//overflow the buffer.
+		raw.resize(capacity);
+		file.read(raw.data(),capacity);
+		std::size_t num_read = file.gcount();
+		for(std::size_t position = 0;position < num_read;++position){
+			char c_char = raw[position];
+			if(c_char >= 'a' && c_char <= 'z'){
+				c_char += 'A' - 'a';
+			}
+			//Store the letter, but only advance past it if it really is a letter.  This avoids a
+			//branch that would be mispredicted whenever letters and spaces are mixed.
+			letters[count] = c_char - 'A';
+			count += (c_char >= 'A' && c_char <= 'Z');
+		}
+	}
+	return count;
+}
+
+void LetterReader::rewind(){
+	file.clear();
+	file.seekg(0);
+}
+
+void LetterReader::resume(){
+	file.clear();
+}
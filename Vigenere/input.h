@@ -0,0 +1,39 @@
+/*
+ * input.h
+ *
+ *      Author: Arthur Laks
+ *  Contains the declaration of the LetterReader class, which reads the letters of a ciphertext
+ *  file a block at a time, so that files of any size can be analyzed in a bounded amount of
+ *  memory.
+ */
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <fstream>
+#include <vector>
+#include <cstddef>
+
+class LetterReader{
+public:
+	explicit LetterReader(const char* filename);
+
+	bool is_open() const{
+		return file.is_open();
+	}
+	//Reads up to capacity letters into the buffer, as numbers between 0 and 25.  Lowercase
+	//letters are treated as uppercase, and all other characters are skipped.  Returns the number
+	//of letters that were read, which is 0 only at the end of the file.
+	std::size_t read(char* letters,std::size_t capacity);
+	//Goes back to the beginning of the file.
+	void rewind();
+	//Continues reading from where the end of the file was reached, in case more was written to
+	//it since then.
+	void resume();
+private:
+	std::ifstream file;
+	//Raw characters are read into this buffer before they are filtered.
+	std::vector<char> raw;
+};
+
+#endif /* INPUT_H */
@@ -0,0 +1,86 @@
+/*
+ * kasiski.cpp
+ *
+ *      Author: Arthur Laks
+ * Contains the implementations of the functions used to perform the Kasiski examination.
+ */
+#include "kasiski.h"
+#include <algorithm>
+#include <cmath>
+
+using std::vector;
+
+KasiskiResult kasiski_examination(const vector<char>& letters,int ngram_length,int min_length,int max_length){
+	KasiskiResult result;
+	result.num_repeats = 0;
+	result.excess.assign(max_length - min_length,0);
+
+	//The code of an n-gram is its letters as a number in base 26, which is updated as the window
+	//rolls forward by removing the first letter and appending the next one.  Every n-gram has a
+	//different code, so the position where each one appeared last can be kept in a flat array.
+	std::size_t num_codes = 1;
+	for(int counter = 0;counter < ngram_length;++counter){
+		num_codes *= ALPHABET_SIZE;
+	}
+	const std::size_t NOT_SEEN = static_cast<std::size_t>(-1);
+	vector<std::size_t> last_position(num_codes,NOT_SEEN);
+	//Count how many repeats there are at each distance.
+	vector<std::size_t> distances(letters.size(),0);
+	std::size_t code = 0;
+	for(std::size_t position = 0;position < letters.size();++position){
+		code = (code * ALPHABET_SIZE + letters[position]) % num_codes;
+		if(position + 1 < static_cast<std::size_t>(ngram_length)){
+			continue;
+		}
+		std::size_t start = position + 1 - ngram_length;
+		if(last_position[code] != NOT_SEEN){
+			++distances[start - last_position[code]];
+			++result.num_repeats;
+		}
+		last_position[code] = start;
+	}
+	if(result.num_repeats == 0){
+		return result;
+	}
+
+	//The number of distances divisible by m is the sum of the counts at the multiples of m.
+	for(int length = min_length;length < max_length;++length){
+		std::size_t divisible = 0;
+		for(std::size_t multiple = length;multiple < distances.size();multiple += length){
+			divisible += distances[multiple];
+		}
+		result.excess[length - min_length] = static_cast<double>(divisible) / result.num_repeats - 1.0 / length;
+	}
+	return result;
+}
+
+LengthScore merge_rankings(const vector<LengthScore>& scores,const KasiskiResult& kasiski){
+	std::size_t count = scores.size();
+	//rank[i] is added the position of length i in each ordering.  Ties keep the shorter length
+	//first.
+	vector<std::size_t> order(count);
+	vector<std::size_t> rank(count,0);
+	for(std::size_t index = 0;index < count;++index){
+		order[index] = index;
+	}
+	auto distance = [&](std::size_t index){
+		double value = std::abs(scores[index].average_ioc - 0.065);
+		//A length with an undefined ioc, because its columns are too short, is the worst.
+		return std::isnan(value) ? 100 : value;
+	};
+	std::stable_sort(order.begin(),order.end(),[&](std::size_t a,std::size_t b){
+		return distance(a) < distance(b);
+	});
+	for(std::size_t position = 0;position < count;++position){
+		rank[order[position]] += position;
+	}
+	if(kasiski.num_repeats){
+		std::stable_sort(order.begin(),order.end(),[&](std::size_t a,std::size_t b){
+			return kasiski.excess[a] > kasiski.excess[b];
+		});
+		for(std::size_t position = 0;position < count;++position){
+			rank[order[position]] += position;
+		}
+	}
+	return scores[std::min_element(rank.begin(),rank.end()) - rank.begin()];
+}
@@ -0,0 +1,38 @@
+/*
+ * kasiski.h
+ *
+ *      Author: Arthur Laks
+ *  Contains the declarations of the functions used to perform the Kasiski examination of a
+ *  Vigenere ciphertext and to combine it with the index of coincidence.
+ */
+
+#ifndef KASISKI_H
+#define KASISKI_H
+
+#include <vector>
+#include <cstddef>
+#include "analysis.h"
+
+//The result of the Kasiski examination.
+struct KasiskiResult{
+	//The number of times that an n-gram was repeated.
+	std::size_t num_repeats;
+	//Element i is the fraction of the distances between repeated n-grams that are divisible by
+	//min_length + i, minus the fraction that would be divisible by it by chance.
+	std::vector<double> excess;
+};
+
+//Finds the distance between every occurrence of each n-gram of the text and the previous
+//occurrence of the same n-gram, and counts how many of those distances each keyword length in
+//the range divides.  Repeated n-grams in the ciphertext are usually the same plaintext
+//encrypted with the same part of the keyword, so the real keyword length divides most of them.
+//The letters are numbers between 0 and 25, and ngram_length is at most 5.
+KasiskiResult kasiski_examination(const std::vector<char>& letters,int ngram_length,
+		int min_length,int max_length);
+
+//Ranks the keyword lengths by the index of coincidence and by the Kasiski examination, and
+//returns the one with the best total rank.  The scores are in order of length, starting from
+//min_length.  If there were no repeated n-grams, the index of coincidence is used alone.
+LengthScore merge_rankings(const std::vector<LengthScore>& scores,const KasiskiResult& kasiski);
+
+#endif /* KASISKI_H */
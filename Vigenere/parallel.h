@@ -0,0 +1,101 @@
+/*
+ * parallel.h
+ *
+ *      Author: Arthur Laks
+ *  Contains a function template that spreads independent iterations of a loop across threads.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <cstddef>
+
+//Returns the number of threads to use if the user did not specify it, which is one per core.
+inline unsigned int default_num_threads(){
+	unsigned int cores = std::thread::hardware_concurrency();
+	return cores ? cores : 1;
+}
+
+//Calls function(i) for every i from 0 up to, but not including, count, using num_threads
+//threads including the calling one.  Each thread takes the next index that was not taken yet,
+//so the work is balanced even if some iterations take longer than others.  The iterations must
+//not depend on each other, and the order in which they run is unspecified.
+template<typename Function>
+void parallel_for(std::size_t count,unsigned int num_threads,Function function){
+	std::atomic<std::size_t> next_index(0);
+	auto worker = [&](){
+		for(std::size_t index = next_index++;index < count;index = next_index++){
+			function(index);
+		}
+	};
+	std::vector<std::thread> threads;
+	for(unsigned int thread = 1;thread < num_threads;++thread){
+		threads.push_back(std::thread(worker));
+	}
+	worker();
+	for(auto& c_thread:threads){
+		c_thread.join();
+	}
+}
+
+//Calls function(i) for every i from 0 up to, but not including, count, like parallel_for, but
+//with a separate queue of indices for each thread.  Each thread starts with a contiguous share
+//of the indices and takes them from the front of its own queue.  When its queue is empty, it
+//steals the index at the back of the queue of another thread, so that a thread that gets
+//several long iterations does not hold up the others.  This is meant for a small number of
+//iterations that each take a long time, such as analyzing whole files.
+template<typename Function>
+void parallel_for_stealing(std::size_t count,unsigned int num_threads,Function function){
+	struct Queue{
+		std::deque<std::size_t> indices;
+		std::mutex mutex;
+	};
+	std::vector<Queue> queues(num_threads);
+	for(unsigned int thread = 0;thread < num_threads;++thread){
+		for(std::size_t index = count * thread / num_threads;index < count * (thread + 1) / num_threads;++index){
+			queues[thread].indices.push_back(index);
+		}
+	}
+	//Takes the next index for a thread, and returns false if there are none left anywhere.
+	auto take = [&](unsigned int thread,std::size_t& index){
+		{
+			std::lock_guard<std::mutex> lock(queues[thread].mutex);
+			if(!queues[thread].indices.empty()){
+				index = queues[thread].indices.front();
+				queues[thread].indices.pop_front();
+				return true;
+			}
+		}
+		for(unsigned int offset = 1;offset < num_threads;++offset){
+			Queue& victim = queues[(thread + offset) % num_threads];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if(!victim.indices.empty()){
+				index = victim.indices.back();
+				victim.indices.pop_back();
+				return true;
+			}
+		}
+		return false;
+	};
+	auto worker = [&](unsigned int thread){
+		std::size_t index;
+		while(take(thread,index)){
+			function(index);
+		}
+	};
+	std::vector<std::thread> threads;
+	for(unsigned int thread = 1;thread < num_threads;++thread){
+		threads.push_back(std::thread(worker,thread));
+	}
+	worker(0);
+	for(auto& c_thread:threads){
+		c_thread.join();
+	}
+}
+
+#endif /* PARALLEL_H */
@@ -0,0 +1,185 @@
+/*
+ * quadgrams.cpp
+ *
+ *      Author: Arthur Laks
+ * Contains the implementation of the QuadgramTable class and of the keyword refinement.
+ */
+#include "quadgrams.h"
+#include <fstream>
+#include <cmath>
+#include <algorithm>
+
+using std::vector;
+using std::string;
+
+bool QuadgramTable::load(const string& filename){
+	std::ifstream file(filename.c_str());
+	if(!file){
+		return false;
+	}
+	vector<double> counts(ALPHABET_SIZE * ALPHABET_SIZE * ALPHABET_SIZE * ALPHABET_SIZE,0);
+	double total = 0;
+	string quadgram;
+	double count;
+	while(file >> quadgram){
+		//Skip comments.
+		if(quadgram[0] == '#'){
+			std::getline(file,quadgram);
+			continue;
+		}
+		//A quadgram without a count means that the file is not in the right format.
+		if(!(file >> count)){
+			return false;
+		}
+		//Skip entries that are not four uppercase letters.
+		if(quadgram.size() != 4 || !std::all_of(quadgram.begin(),quadgram.end(),
+				[](char letter){return letter >= 'A' && letter <= 'Z';})){
+			continue;
+		}
+		int index = 0;
+		for(char letter:quadgram){
+			index = index * ALPHABET_SIZE + (letter - 'A');
+		}
+		counts[index] += count;
+		total += count;
+	}
+	if(total == 0){
+		return false;
+	}
+	//A quadgram that was never seen is treated as if it had been seen a hundredth of a time.
+	table.resize(counts.size());
+	for(std::size_t index = 0;index < counts.size();++index){
+		table[index] = std::log10((counts[index] ? counts[index] : 0.01) / total);
+	}
+	return true;
+}
+
+double QuadgramTable::score_text(const char* letters,std::size_t count) const{
+	double total = 0;
+	for(std::size_t start = 0;start + 4 <= count;++start){
+		total += score(letters + start);
+	}
+	return total;
+}
+
+namespace{
+//Shifts every letter of one column of the ciphertext back by the shift, and stores the result
+//in the same positions of the plaintext.
+void decrypt_column(const vector<char>& ciphertext,vector<char>& plaintext,std::size_t column,
+		std::size_t length,int shift){
+	for(std::size_t position = column;position < ciphertext.size();position += length){
+		int letter = ciphertext[position] - shift;
+		plaintext[position] = letter < 0 ? letter + ALPHABET_SIZE : letter;
+	}
+}
+
+//Finds the starting positions of the quadgrams that contain a letter of the column.  If the
+//keyword has at least 4 letters, the quadgrams that contain different letters of the column do
+//not overlap, and otherwise every quadgram contains a letter of the column.
+void affected_quadgrams(std::size_t num_letters,std::size_t column,std::size_t length,
+		vector<std::size_t>& starts){
+	starts.clear();
+	if(num_letters < 4){
+		return;
+	}
+	std::size_t last_start = num_letters - 4;
+	if(length < 4){
+		for(std::size_t start = 0;start <= last_start;++start){
+			starts.push_back(start);
+		}
+		return;
+	}
+	for(std::size_t position = column;position < num_letters;position += length){
+		for(std::size_t start = position < 3 ? 0 : position - 3;start <= position && start <= last_start;++start){
+			starts.push_back(start);
+		}
+	}
+}
+
+//Hill climbs from the keyword, given as shifts, and returns the score of the decryption with
+//the final keyword.  Only the quadgrams that contain a letter of the column whose shift is
+//being changed are rescored.
+double climb(const QuadgramTable& table,const vector<char>& ciphertext,vector<int>& shifts){
+	std::size_t length = shifts.size();
+	vector<char> plaintext(ciphertext.size());
+	for(std::size_t column = 0;column < length;++column){
+		decrypt_column(ciphertext,plaintext,column,length,shifts[column]);
+	}
+	double fitness = table.score_text(plaintext.data(),plaintext.size());
+
+	vector<std::size_t> starts;
+	auto score_starts = [&](){
+		double total = 0;
+		for(std::size_t start:starts){
+			total += table.score(&plaintext[start]);
+		}
+		return total;
+	};
+	bool improved = true;
+	while(improved){
+		improved = false;
+		for(std::size_t column = 0;column < length;++column){
+			affected_quadgrams(plaintext.size(),column,length,starts);
+			double current_score = score_starts();
+			double best_score = current_score;
+			int best_shift = shifts[column];
+			for(int shift = 0;shift < ALPHABET_SIZE;++shift){
+				if(shift == shifts[column]){
+					continue;
+				}
+				decrypt_column(ciphertext,plaintext,column,length,shift);
+				double new_score = score_starts();
+				if(new_score > best_score){
+					best_score = new_score;
+					best_shift = shift;
+				}
+			}
+			decrypt_column(ciphertext,plaintext,column,length,best_shift);
+			if(best_shift != shifts[column]){
+				shifts[column] = best_shift;
+				fitness += best_score - current_score;
+				improved = true;
+			}
+		}
+	}
+	return fitness;
+}
+}
+
+string refine_keyword(const QuadgramTable& table,const vector<char>& ciphertext,const string& keyword){
+	vector<int> shifts;
+	for(char letter:keyword){
+		shifts.push_back(letter - 'A');
+	}
+	double fitness = climb(table,ciphertext,shifts);
+
+	//Check whether a keyword whose length divides the length of this one decrypts the text
+	//about as well, starting from the shortest.  Each letter of the shorter keyword starts as the
+	//most common of the letters that it repeats.  A longer keyword can always fit the text a
+	//little better, so allow the shorter one to score slightly lower.
+	const double TOLERANCE = 0.01;
+	for(std::size_t length = 1;length < shifts.size();++length){
+		if(shifts.size() % length != 0){
+			continue;
+		}
+		vector<int> shorter(length);
+		for(std::size_t position = 0;position < length;++position){
+			int votes[ALPHABET_SIZE] = {0};
+			for(std::size_t repeat = position;repeat < shifts.size();repeat += length){
+				++votes[shifts[repeat]];
+			}
+			shorter[position] = std::max_element(votes,votes + ALPHABET_SIZE) - votes;
+		}
+		double shorter_fitness = climb(table,ciphertext,shorter);
+		if(shorter_fitness >= fitness - TOLERANCE * std::abs(fitness)){
+			shifts = shorter;
+			break;
+		}
+	}
+
+	string retval;
+	for(int shift:shifts){
+		retval.push_back('A' + shift);
+	}
+	return retval;
+}
@@ -0,0 +1,47 @@
+/*
+ * quadgrams.h
+ *
+ *      Author: Arthur Laks
+ *  Contains the declarations of the QuadgramTable class, which scores how much a text looks like
+ *  English, and of the function that uses it to correct the keyword guessed from the index of
+ *  coincidence.
+ */
+
+#ifndef QUADGRAMS_H
+#define QUADGRAMS_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include "analysis.h"
+
+//Stores the logarithm of the probability of every sequence of four letters in English in a flat
+//array, indexed by the four letters as a number in base 26.  Quadgrams that did not appear in the
+//counts get a very low probability.
+class QuadgramTable{
+public:
+	//Reads the counts from a file where each line has a quadgram in uppercase and its count.
+	//Lines that start with '#' are ignored.  Returns false if the file could not be read.
+	bool load(const std::string& filename);
+
+	//Returns the score of the four letters starting at the argument, which are numbers between
+	//0 and 25.
+	float score(const char* letters) const{
+		return table[((letters[0] * ALPHABET_SIZE + letters[1]) * ALPHABET_SIZE + letters[2]) * ALPHABET_SIZE
+				+ letters[3]];
+	}
+	//Returns the sum of the scores of every quadgram in the text.  The higher the result, the
+	//more the text looks like English.
+	double score_text(const char* letters,std::size_t count) const;
+private:
+	std::vector<float> table;
+};
+
+//Improves the keyword by hill climbing: each letter of the keyword is replaced by the letter
+//that makes the decryption of the ciphertext score the highest, until no single letter can be
+//improved.  If the keyword is a repetition of a shorter keyword, such as a keyword twice as long
+//as the real one, the shorter keyword is returned.  The ciphertext is given as numbers between
+//0 and 25, starting from the beginning of the text.
+std::string refine_keyword(const QuadgramTable&,const std::vector<char>& ciphertext,const std::string& keyword);
+
+#endif /* QUADGRAMS_H */
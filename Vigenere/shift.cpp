@@ -0,0 +1,96 @@
+/*
+ * shift.cpp
+ *
+ *      Author: Arthur Laks
+ * Contains the implementation of the function that encrypts or decrypts text with a keyword.
+ */
+#include "shift.h"
+#include <vector>
+#include "analysis.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace{
+#if defined(__AVX2__)
+typedef __m256i Vector;
+const std::size_t VECTOR_SIZE = 32;
+inline Vector load(const char* address){
+	return _mm256_loadu_si256(reinterpret_cast<const Vector*>(address));
+}
+inline void store(char* address,Vector value){
+	_mm256_storeu_si256(reinterpret_cast<Vector*>(address),value);
+}
+//Returns (letters + shifts) mod 26, or (letters - shifts) mod 26 if decrypt is true.
+inline Vector shift(Vector letters,Vector shifts,bool decrypt){
+	if(decrypt){
+		Vector difference = _mm256_sub_epi8(letters,shifts);
+		//Add 26 to the negative differences.
+		Vector negative = _mm256_cmpgt_epi8(_mm256_setzero_si256(),difference);
+		return _mm256_add_epi8(difference,_mm256_and_si256(negative,_mm256_set1_epi8(ALPHABET_SIZE)));
+	}
+	Vector sum = _mm256_add_epi8(letters,shifts);
+	//Subtract 26 from the sums that are past the end of the alphabet.
+	Vector past_end = _mm256_cmpgt_epi8(sum,_mm256_set1_epi8(ALPHABET_SIZE - 1));
+	return _mm256_sub_epi8(sum,_mm256_and_si256(past_end,_mm256_set1_epi8(ALPHABET_SIZE)));
+}
+#elif defined(__SSE2__)
+typedef __m128i Vector;
+const std::size_t VECTOR_SIZE = 16;
+inline Vector load(const char* address){
+	return _mm_loadu_si128(reinterpret_cast<const Vector*>(address));
+}
+inline void store(char* address,Vector value){
+	_mm_storeu_si128(reinterpret_cast<Vector*>(address),value);
+}
+inline Vector shift(Vector letters,Vector shifts,bool decrypt){
+	if(decrypt){
+		Vector difference = _mm_sub_epi8(letters,shifts);
+		Vector negative = _mm_cmpgt_epi8(_mm_setzero_si128(),difference);
+		return _mm_add_epi8(difference,_mm_and_si128(negative,_mm_set1_epi8(ALPHABET_SIZE)));
+	}
+	Vector sum = _mm_add_epi8(letters,shifts);
+	Vector past_end = _mm_cmpgt_epi8(sum,_mm_set1_epi8(ALPHABET_SIZE - 1));
+	return _mm_sub_epi8(sum,_mm_and_si128(past_end,_mm_set1_epi8(ALPHABET_SIZE)));
+}
+#else
+const std::size_t VECTOR_SIZE = 1;
+#endif
+}
+
+void shift_by_keyword(char* letters,std::size_t count,const std::string& keyword,
+		unsigned long long position,bool decrypt){
+	std::size_t length = keyword.length();
+	//The shifts of the letters starting from any position in the keyword are consecutive in
+	//the buffer.
+	std::vector<char> shifts(length + VECTOR_SIZE);
+	for(std::size_t index = 0;index < shifts.size();++index){
+		shifts[index] = keyword[index % length] - 'A';
+	}
+	std::size_t phase = position % length;
+	std::size_t index = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+	//Moving forward by a whole vector moves the phase forward by VECTOR_SIZE mod length.
+	std::size_t phase_step = VECTOR_SIZE % length;
+	for(;index + VECTOR_SIZE <= count;index += VECTOR_SIZE){
+		store(letters + index,shift(load(letters + index),load(&shifts[phase]),decrypt));
+		phase += phase_step;
+		if(phase >= length){
+			phase -= length;
+		}
+	}
+#endif
+	//Shift the rest of the letters one at a time, the same way.
+	int sign = decrypt ? -1 : 1;
+	for(;index < count;++index){
+		int result = letters[index] + sign * shifts[phase];
+		result += ALPHABET_SIZE & -(result < 0);
+		result -= ALPHABET_SIZE & -(result >= ALPHABET_SIZE);
+		letters[index] = result;
+		if(++phase == length){
+			phase = 0;
+		}
+	}
+}
@@ -0,0 +1,27 @@
+/*
+ * shift.h
+ *
+ *      Author: Arthur Laks
+ *  Contains the declaration of the function that encrypts or decrypts text with a Vigenere
+ *  keyword.
+ */
+
+#ifndef SHIFT_H
+#define SHIFT_H
+
+#include <string>
+#include <cstddef>
+
+//Shifts every letter of the text forward (to encrypt) or back (to decrypt) by the letter of the
+//keyword at its position mod 26.  The letters are numbers between 0 and 25, and are replaced by
+//the result.  The keyword is in uppercase, and position is the position of the first letter in
+//the whole text, so that a text can be processed a block at a time.
+//
+//The keyword is repeated into a buffer so that the shifts of any 16 or 32 consecutive letters can
+//be loaded at once, and the letters are shifted with SSE2 or AVX2 instructions if the compiler
+//supports them.  The result is corrected by adding or subtracting 26 under a comparison mask, so
+//there are no branches.
+void shift_by_keyword(char* letters,std::size_t count,const std::string& keyword,
+		unsigned long long position,bool decrypt);
+
+#endif /* SHIFT_H */
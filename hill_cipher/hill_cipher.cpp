@@ -16,6 +16,7 @@
 #include <unordered_set>
 
 #include "math_lib.h"
+#include "stream.h"
 
 using std::string;
 using std::cout;
@@ -42,31 +43,28 @@ vector<int> to_numbers(const string& text)
 }
 
 //Takes a matrix and displays it.
-void display_matrix(const Matrix& matrix){
-    for(auto row : matrix){
-        for(int element:row)        {
-            //Put a tab between columns and a newline between rows.
-            cout << element << "\t";
-        }
-        cout << endl;
-    }
+template<unsigned Rows,unsigned Columns>
+void display_matrix(const BasicMatrix<Rows,Columns>& matrix){
+    write_matrix(cout,matrix);
 }
 
-//Converts an iterator to a matrix with the specified number of rows and columns.
-template<typename iterator>
-Matrix to_matrix(iterator begin,unsigned rows,unsigned columns){
-
-    Matrix retval(rows,vector<int>(columns));
-    for(unsigned i = 0;i < rows;++i){
-        std::copy(begin + i * columns,begin + (i + 1) * columns,retval[i].begin());
-    }
+//Converts an iterator to a matrix with the specified number of rows and columns.  The dimensions that
+//are known at compile time are passed as template arguments.
+template<unsigned Rows,unsigned Columns,typename iterator>
+BasicMatrix<Rows,Columns> to_matrix(iterator begin,unsigned rows = Rows,unsigned columns = Columns){
+    BasicMatrix<Rows,Columns> retval(rows,columns);
+    std::copy(begin,begin + rows * columns,retval.data());
     return retval;
 }
 
+const unsigned int BLOCK_SIZE = 5;
+//The key and the blocks of 25 characters that are used to recover it.
+typedef BasicMatrix<BLOCK_SIZE,BLOCK_SIZE> KeyMatrix;
+
 int main(int argc,char* args[]){
   if(argc < 5){
     cerr << "Usage: hill_cipher known_plaintext_file known_ciphertext_file "
-      "unknown_ciphertext_file decryption_file" << endl;
+      "unknown_ciphertext_file decryption_file [key_file]" << endl;
   return 1;
   }
   
@@ -85,16 +83,14 @@ int main(int argc,char* args[]){
     vector<int> plaintext_numbers = to_numbers(known_plaintext);
 
 
-    const unsigned int BLOCK_SIZE = 5;
-
-    Matrix plaintext_matrix;
+    KeyMatrix plaintext_matrix;
 
-    Matrix ciphertext_matrix;
+    KeyMatrix ciphertext_matrix;
     //Find the first 5 blocks of plaintext that form a matrix that is invertible mod 26.
     for(int offset = 0;offset < 45;++offset){
         //Convert the block of 25 characters starting with offset to a matrix.
-        plaintext_matrix = to_matrix(plaintext_numbers.begin() + offset * BLOCK_SIZE,BLOCK_SIZE,BLOCK_SIZE);
-        ciphertext_matrix = to_matrix(ciphertext_numbers.begin() + offset * BLOCK_SIZE,BLOCK_SIZE,BLOCK_SIZE);
+        plaintext_matrix = to_matrix<BLOCK_SIZE,BLOCK_SIZE>(plaintext_numbers.begin() + offset * BLOCK_SIZE);
+        ciphertext_matrix = to_matrix<BLOCK_SIZE,BLOCK_SIZE>(ciphertext_numbers.begin() + offset * BLOCK_SIZE);
 
         //Determine if the matrix is invertible.
         bool invertible = invert(plaintext_matrix,26);
@@ -106,10 +102,20 @@ int main(int argc,char* args[]){
 
 
     //Recover the key by multiplying the inverse of the plaintext matrix by the corresponding ciphertext matrix.
-    Matrix key = multiply(plaintext_matrix,ciphertext_matrix,26);
+    KeyMatrix key = multiply(plaintext_matrix,ciphertext_matrix,26);
     cout << "Here is the key used for encryption: " << endl;
     display_matrix(key);
 
+    //Save the key so that hill_stream can encrypt and decrypt other files with it.
+    if(argc > 5){
+      std::ofstream key_file(args[5]);
+      if(!key_file){
+        cerr << "Could not create the key file." << endl;
+        return 2;
+      }
+      write_matrix(key_file,key);
+    }
+
     //Invert the key in order to obtain the matrix used for decryption.
     invert(key,26);
     cout << "Here is the key used for decryption: " << endl;
@@ -121,25 +127,15 @@ int main(int argc,char* args[]){
       cerr << "Unknown ciphertext file does not exist." << endl;
       return 2;
     }
-    string unknown_ciphertext_string(istream_iterator<char>(ciphertext_file),(istream_iterator<char>()));
-    vector<int> unknown_ciphertext = to_numbers(unknown_ciphertext_string);
-
-    Matrix unknown_ciphertext_matrix
-        = to_matrix(unknown_ciphertext.begin(),unknown_ciphertext.size() / BLOCK_SIZE,BLOCK_SIZE);
-
-    //Decrypt the unknown ciphertext matrix by multiplying it by the inverse of the key.
-    Matrix unknown_plaintext_matrix = multiply(unknown_ciphertext_matrix,key,26);
-
-    //Write the decrypted plaintext to a file.
+    //Decrypt the unknown ciphertext a block at a time by multiplying each block by the inverse of the key,
+    //and write the decrypted plaintext to a file.  Letters at the end that do not fill a block are ignored.
     std::ofstream output_file(args[4],std::ios::out);
-    std::ostream_iterator<char> output(output_file);
-
-    //Convert each row of the matrix to a string and write it to the file.
-    for(auto block:unknown_plaintext_matrix){
-        std::transform(block.begin(),block.end(),output,
-            [](int n){return static_cast<char>(n + 'a');});
+    if(!output_file){
+      cerr << "Could not create the decryption file." << endl;
+      return 2;
     }
-
+    //Only uppercase letters are part of the ciphertext, as in the known texts.
+    transform_stream(ciphertext_file,output_file,Matrix(key),'a',false,false);
 
     return 0;
 }
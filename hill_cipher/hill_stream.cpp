@@ -0,0 +1,59 @@
+/*
+ * hill_stream.cpp
+ *
+ *      Author: Arthur Laks
+ * Encrypts or decrypts a file of any size with the hill cipher, using a key file that was
+ * written by hill_cipher.  Encryption writes uppercase letters and pads the last block with
+ * 'Z', and decryption writes lowercase letters, like hill_cipher.
+ */
+
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+#include "math_lib.h"
+#include "stream.h"
+
+using std::cerr;
+using std::endl;
+
+int main(int argc,char* args[]){
+    if(argc != 5 || (std::strcmp(args[1],"-e") != 0 && std::strcmp(args[1],"-d") != 0)){
+        cerr << "Usage: hill_stream -e|-d key_file input_file output_file" << endl;
+        return 1;
+    }
+    bool encrypt = args[1][1] == 'e';
+    std::ifstream key_file(args[2]);
+    std::ifstream input_file(args[3],std::ios::in|std::ios::binary);
+    if(!key_file || !input_file){
+        cerr << "File does not exist." << endl;
+        return 2;
+    }
+    Matrix key;
+    if(!read_key(key_file,key)){
+        cerr << "The key file does not contain a square matrix of numbers between 0 and 25." << endl;
+        return 2;
+    }
+    //A key that is not invertible would encrypt to a ciphertext that cannot be decrypted.  The key
+    //file has the key used for encryption, so use the inverse to decrypt.
+    Matrix inverse(key);
+    if(!invert(inverse,26)){
+        cerr << "The key is not invertible mod 26." << endl;
+        return 2;
+    }
+    std::ofstream output_file(args[4],std::ios::out|std::ios::binary);
+    if(!output_file){
+        cerr << "Could not create the output file." << endl;
+        return 2;
+    }
+    std::size_t left_over = transform_stream(input_file,output_file,encrypt ? key : inverse,encrypt ? 'A' : 'a',
+            encrypt,true);
+    if(!output_file){
+        cerr << "Could not write the output file." << endl;
+        return 2;
+    }
+    if(left_over && !encrypt){
+        cerr << "The last " << left_over << " letters did not fill a block, so they were ignored." << endl;
+    }
+    return 0;
+}
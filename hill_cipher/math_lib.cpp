@@ -8,10 +8,19 @@
  */
 #include "math_lib.h"
 #include <algorithm>
-using std::vector;
-using std::swap;
+#include <cassert>
 using std::transform;
 
+//The number of rows and columns of the result, and of rows of the rhs, that multiply works on
+//at a time.
+const unsigned ROW_BLOCK = 32;
+const unsigned COLUMN_BLOCK = 64;
+const unsigned INNER_BLOCK = 128;
+//The widest rhs that multiply handles by transposing the lhs, and the number of rows of the lhs
+//that are transposed at a time.
+const unsigned NARROW_COLUMNS = 8;
+const unsigned NARROW_ROW_BLOCK = 64;
+
 //The anonymous namespace contains functions that are used internally in the module.
 
 //The following code is from http://www.pagedon.com/extended-euclidean-algorithm-in-c/my_programming/
@@ -65,23 +74,23 @@ gcd ( int a, int b )
 
 //Adds the row beginning with dest_begin to a multiple of the row beginning with source_begin in Zn,
 //and replaces the row beginning with dest_begin with the result.
-void add_rows(vector<int>::iterator source_begin,vector<int>::iterator source_end,
-		vector<int>::iterator dest_begin,int multiply_by,int n){
+void add_rows(const int* source_begin,const int* source_end,int* dest_begin,int multiply_by,int n){
 	transform(source_begin,source_end,dest_begin,dest_begin,
 			[&](int a,int b){return (b + multiply_by * a) % n;});
 }
 }
 
-//Inverts a matrix in Zn.  The parameter is turned into the inverse.  Returns true if the matrix is invertible.
-//The argument represents the left-hand-side of the augmented matrix.
-bool invert(Matrix& lhs,unsigned n){
-	unsigned dimension = lhs.size();
-	Matrix rhs(lhs.size(),vector<int>(lhs.size(),0));	//Represents the right-hand-side of the augmented matrix.
-	//All row operations will be performed on both matrices, and then they will be swapped.
+//Inverts a matrix in Zn.  The first parameter is turned into the inverse.  Returns true if the matrix is invertible.
+//The first argument represents the left-hand-side of the augmented matrix, and the second one the right-hand-side.
+bool invert(int* lhs,int* rhs,unsigned dimension,unsigned n){
+	//All row operations will be performed on both matrices, and then the rhs will be copied to the lhs.
+	auto lhs_row = [&](unsigned row){return lhs + row * dimension;};
+	auto rhs_row = [&](unsigned row){return rhs + row * dimension;};
 
 	//Initialize to an identity matrix.
+	std::fill(rhs,rhs + dimension * dimension,0);
 	for(unsigned i = 0;i < dimension;++i){
-	  rhs[i][i] = 1;
+	  rhs_row(i)[i] = 1;
 	}
 
 	//For each row.
@@ -89,38 +98,39 @@ bool invert(Matrix& lhs,unsigned n){
 		//Make sure the element in the pivot position is 1.
 		//If the element in the pivot position is 0 or does not have an inverse mod n,
 		//swap it with the first one that is.
-		if(!lhs[row][row] || gcd(lhs[row][row],n) != 1){
+		if(!lhs_row(row)[row] || gcd(lhs_row(row)[row],n) != 1){
 			//Find the first row that has a number that is invertible mod n in the position below the pivot position.
-			auto nonzero_row = std::find_if(lhs.begin() + row + 1,lhs.end(),
-					[&](const vector<int>& c_row){return c_row[row] && gcd(c_row[row],n) == 1;});
+			unsigned nonzero_row = row + 1;
+			while(nonzero_row < dimension && !(lhs_row(nonzero_row)[row] && gcd(lhs_row(nonzero_row)[row],n) == 1)){
+				++nonzero_row;
+			}
 			//If such a row does not exist, the matrix is singular, so return false.
-			if(nonzero_row == lhs.end()){
+			if(nonzero_row == dimension){
 				return false;
 			}
 			//Swap the current row with that row in both parts of the augmented matrix.
-			std::iter_swap(lhs.begin() + row,nonzero_row);
-
-			swap(rhs[row],rhs[nonzero_row - lhs.begin()]);
+			std::swap_ranges(lhs_row(row),lhs_row(row) + dimension,lhs_row(nonzero_row));
+			std::swap_ranges(rhs_row(row),rhs_row(row) + dimension,rhs_row(nonzero_row));
 		}
 
 		//Multiply the row by the inverse of the element at the pivot position to turn the
 		//pivot position to 1.
 
-		int inverse = find_inverse(lhs[row][row],n);
+		int inverse = find_inverse(lhs_row(row)[row],n);
 		//All of the previous columns of the lhs are assumed to be zero, so start from row.
-		transform(lhs[row].begin()+ row,lhs[row].end(),lhs[row].begin() + row,
+		transform(lhs_row(row) + row,lhs_row(row) + dimension,lhs_row(row) + row,
 				[&](int element){return (element * inverse) % n;});
 
 		//Perform the same operation for the rhs.
-		transform(rhs[row].begin(),rhs[row].end(),rhs[row].begin(),
+		transform(rhs_row(row),rhs_row(row) + dimension,rhs_row(row),
 				[&](int element){return (element * inverse) % n;});
 
 		//Turn all of the columns under the pivot position to zero.
 		for(unsigned c_row = row + 1;c_row < dimension;++c_row){
-			int multiply_by = n - lhs[c_row][row];
-			add_rows(lhs[row].begin() + row,lhs[row].end(),lhs[c_row].begin() + row,
+			int multiply_by = n - lhs_row(c_row)[row];
+			add_rows(lhs_row(row) + row,lhs_row(row) + dimension,lhs_row(c_row) + row,
 					multiply_by,n);
-			add_rows(rhs[row].begin(),rhs[row].end(),rhs[c_row].begin(),multiply_by,n);
+			add_rows(rhs_row(row),rhs_row(row) + dimension,rhs_row(c_row),multiply_by,n);
 		}
 	}
 
@@ -129,28 +139,143 @@ bool invert(Matrix& lhs,unsigned n){
 	for(int row = dimension - 1;row >= 0;--row){
 
 		for(int c_row = 0;c_row < row;++c_row){
-			unsigned int multiply_by = n - lhs[c_row][row];
-			add_rows(lhs[row].begin() + row,lhs[row].end(),lhs[c_row].begin() + row
+			unsigned int multiply_by = n - lhs_row(c_row)[row];
+			add_rows(lhs_row(row) + row,lhs_row(row) + dimension,lhs_row(c_row) + row
 					,multiply_by,n);
-			add_rows(rhs[row].begin(),rhs[row].end(),rhs[c_row].begin(),multiply_by,n);
+			add_rows(rhs_row(row),rhs_row(row) + dimension,rhs_row(c_row),multiply_by,n);
 		}
 	}
 
-	swap(rhs,lhs);
+	std::copy(rhs,rhs + dimension * dimension,lhs);
 	return true;
 }
 
-//Multiplies the two matrices in Zn, returning the result.
-Matrix multiply(const Matrix& lhs,const Matrix& rhs,unsigned int n){
-    Matrix result(lhs.size(),vector<int>(rhs.size()));
-    //For each row i and column j of the resulting matrix, assign in to the inner product of row i of rhs and column j
-    //of lhs.
-    for(unsigned int i = 0; i < lhs.size(); ++i) {
-        for(unsigned int j = 0; j < rhs.size(); ++j) {
-            result[i][j] = std::inner_product(lhs[i].begin(),lhs[i].end(),rhs.begin(),0,
-                        [&] (int a,int b) {return (a + b) % n;},
-                        [&](int a,vector<int> row) {return (a * row[j]) % n;});
-        }
-    }
-    return result;
+namespace{
+//Reduces sums mod n.  A sum that is less than 2^32 is reduced by multiplying it by the
+//reciprocal of n in double precision, which is exact up to rounding the quotient by one, and
+//correcting that, which is much faster than dividing.
+inline int reduce(unsigned sum,unsigned n,double reciprocal){
+	int remainder = static_cast<int>(sum - static_cast<unsigned>(sum * reciprocal) * n);
+	remainder += remainder < 0 ? n : 0;
+	return remainder >= static_cast<int>(n) ? remainder - n : remainder;
+}
+inline int reduce(unsigned long long sum,unsigned n,double){
+	return sum % n;
+}
+
+//Multiplies the matrices like multiply, with sums of the specified type.
+template<typename Sum>
+void multiply_blocks(const int* lhs,const int* rhs,int* result,unsigned rows,unsigned inner,unsigned columns,
+		unsigned n){
+	const double reciprocal = 1.0 / n;
+	Sum sums[ROW_BLOCK][COLUMN_BLOCK];
+	for(unsigned row_begin = 0;row_begin < rows;row_begin += ROW_BLOCK){
+		unsigned row_count = std::min(ROW_BLOCK,rows - row_begin);
+		for(unsigned column_begin = 0;column_begin < columns;column_begin += COLUMN_BLOCK){
+			unsigned column_count = std::min(COLUMN_BLOCK,columns - column_begin);
+			for(unsigned row = 0;row < row_count;++row){
+				std::fill(sums[row],sums[row] + column_count,0);
+			}
+			for(unsigned inner_begin = 0;inner_begin < inner;inner_begin += INNER_BLOCK){
+				unsigned inner_end = std::min(inner_begin + INNER_BLOCK,inner);
+				for(unsigned row = 0;row < row_count;++row){
+					const int* lhs_row = lhs + static_cast<size_t>(row_begin + row) * inner;
+					Sum* sum_row = sums[row];
+					for(unsigned k = inner_begin;k < inner_end;++k){
+						Sum multiply_by = lhs_row[k];
+						const int* rhs_row = rhs + static_cast<size_t>(k) * columns + column_begin;
+						for(unsigned column = 0;column < column_count;++column){
+							sum_row[column] += multiply_by * static_cast<Sum>(rhs_row[column]);
+						}
+					}
+				}
+			}
+			for(unsigned row = 0;row < row_count;++row){
+				int* result_row = result + static_cast<size_t>(row_begin + row) * columns + column_begin;
+				for(unsigned column = 0;column < column_count;++column){
+					result_row[column] = reduce(sums[row][column],n,reciprocal);
+				}
+			}
+		}
+	}
+}
+
+//Multiplies the matrices like multiply_blocks, for an rhs with at most NARROW_COLUMNS columns,
+//such as the key of a Hill cipher.  Rows of the result that are that short would make the
+//innermost loop of multiply_blocks too short to vectorize, so the tile of the lhs is transposed
+//and the innermost loop goes over the rows of the tile instead, a fixed number of times.
+template<typename Sum>
+void multiply_narrow(const int* lhs,const int* rhs,int* result,unsigned rows,unsigned inner,unsigned columns,
+		unsigned n){
+	const double reciprocal = 1.0 / n;
+	Sum transposed[INNER_BLOCK][NARROW_ROW_BLOCK];
+	Sum sums[NARROW_COLUMNS][NARROW_ROW_BLOCK];
+	for(unsigned row_begin = 0;row_begin < rows;row_begin += NARROW_ROW_BLOCK){
+		unsigned row_count = std::min(NARROW_ROW_BLOCK,rows - row_begin);
+		for(unsigned column = 0;column < columns;++column){
+			std::fill(sums[column],sums[column] + NARROW_ROW_BLOCK,0);
+		}
+		for(unsigned inner_begin = 0;inner_begin < inner;inner_begin += INNER_BLOCK){
+			unsigned inner_count = std::min(INNER_BLOCK,inner - inner_begin);
+			//The rows past the end of the lhs are zero.
+			for(unsigned row = 0;row < row_count;++row){
+				const int* lhs_row = lhs + static_cast<size_t>(row_begin + row) * inner + inner_begin;
+				for(unsigned k = 0;k < inner_count;++k){
+					transposed[k][row] = lhs_row[k];
+				}
+			}
+			for(unsigned k = 0;k < inner_count;++k){
+				std::fill(transposed[k] + row_count,transposed[k] + NARROW_ROW_BLOCK,0);
+			}
+			for(unsigned k = 0;k < inner_count;++k){
+				const int* rhs_row = rhs + static_cast<size_t>(inner_begin + k) * columns;
+				for(unsigned column = 0;column < columns;++column){
+					Sum multiply_by = rhs_row[column];
+					for(unsigned row = 0;row < NARROW_ROW_BLOCK;++row){
+						sums[column][row] += transposed[k][row] * multiply_by;
+					}
+				}
+			}
+		}
+		for(unsigned row = 0;row < row_count;++row){
+			int* result_row = result + static_cast<size_t>(row_begin + row) * columns;
+			for(unsigned column = 0;column < columns;++column){
+				result_row[column] = reduce(sums[column][row],n,reciprocal);
+			}
+		}
+	}
+}
+
+//Multiplies the matrices with multiply_narrow if the rhs is narrow, and otherwise with
+//multiply_blocks.
+template<typename Sum>
+void multiply_with(const int* lhs,const int* rhs,int* result,unsigned rows,unsigned inner,unsigned columns,
+		unsigned n){
+	if(columns <= NARROW_COLUMNS){
+		multiply_narrow<Sum>(lhs,rhs,result,rows,inner,columns,n);
+	}else{
+		multiply_blocks<Sum>(lhs,rhs,result,rows,inner,columns,n);
+	}
+}
+}
+
+//Multiplies the two matrices in Zn, storing the result in the third argument.
+//The result is computed a tile of rows and columns at a time.  The sums for the tile are kept
+//in integers that are wide enough for a whole inner product, and each one is only reduced mod n
+//once, when it is finished.  The innermost loop adds a multiple of a row of the rhs to a row of
+//sums, so the compiler can vectorize it.  The rows of the rhs are used in blocks that fit in
+//the cache together with the tile.  An rhs with only a few columns, like the key when a whole
+//text is decrypted, is handled by multiply_narrow instead.
+void multiply(const int* lhs,const int* rhs,int* result,unsigned rows,unsigned inner,unsigned columns,unsigned n){
+	//Use 32 bit sums, which take half as much space in a vector register, if they cannot
+	//overflow, which is the case for small keys mod 26.
+	unsigned long long largest_product = static_cast<unsigned long long>(n - 1) * (n - 1);
+	//The sums must not overflow even in 64 bits.
+	assert(n > 0 && n < (1U << 31) && (!inner || largest_product <= ~0ULL / inner));
+	unsigned long long largest_sum = largest_product * inner;
+	if(largest_sum < (1ULL << 32)){
+		multiply_with<unsigned>(lhs,rhs,result,rows,inner,columns,n);
+	}else{
+		multiply_with<unsigned long long>(lhs,rhs,result,rows,inner,columns,n);
+	}
 }
@@ -3,20 +3,103 @@
  *
  *  Created on: Apr 26, 2015
  *      Author: Arthur Laks
- *  Contains the declarations of functions used to
+ *  Contains the declarations of functions used to invert and multiply matrices in Zn, and the
+ *  matrix type that they use.
  */
 
 #ifndef MATH_LIB_H
 #define MATH_LIB_H
 
 #include <vector>
-typedef std::vector<std::vector<int> > Matrix;
+#include <array>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+//A dimension of a matrix that is only known at run time.
+const unsigned DYNAMIC = 0;
+
+//The elements of a matrix.  If the number of elements is known at compile time they are stored
+//in the object itself, so a small matrix does not allocate, and otherwise they are stored in a
+//vector.  The elements start at zero.
+template<std::size_t Size>
+struct MatrixStorage{
+	std::array<int,Size> elements;
+	explicit MatrixStorage(std::size_t){
+		elements.fill(0);
+	}
+	int* data(){return elements.data();}
+	const int* data() const{return elements.data();}
+};
+
+template<>
+struct MatrixStorage<0>{
+	std::vector<int> elements;
+	explicit MatrixStorage(std::size_t size):elements(size,0){}
+	int* data(){return elements.data();}
+	const int* data() const{return elements.data();}
+};
+
+//A matrix of ints whose elements are stored contiguously, one row after another.  Either
+//dimension can be DYNAMIC, in which case it is passed to the constructor.  m[i][j] is the
+//element at row i and column j.
+template<unsigned Rows,unsigned Columns>
+class BasicMatrix{
+public:
+	//A dimension that is fixed must be passed as itself or omitted.
+	explicit BasicMatrix(unsigned rows = Rows,unsigned columns = Columns):
+			num_rows(rows),num_columns(columns),storage(static_cast<std::size_t>(rows) * columns){
+		assert((!Rows || rows == Rows) && (!Columns || columns == Columns));
+	}
+	//Copies a matrix with the same dimensions whose dimensions are fixed differently.
+	template<unsigned Other_Rows,unsigned Other_Columns>
+	explicit BasicMatrix(const BasicMatrix<Other_Rows,Other_Columns>& other):
+			BasicMatrix(other.rows(),other.columns()){
+		std::copy(other.data(),other.data() + static_cast<std::size_t>(other.rows()) * other.columns(),data());
+	}
+	unsigned rows() const{return Rows ? Rows : num_rows;}
+	unsigned columns() const{return Columns ? Columns : num_columns;}
+	int* operator[](unsigned row){return storage.data() + row * columns();}
+	const int* operator[](unsigned row) const{return storage.data() + row * columns();}
+	int* data(){return storage.data();}
+	const int* data() const{return storage.data();}
+private:
+	unsigned num_rows,num_columns;
+	MatrixStorage<static_cast<std::size_t>(Rows) * Columns> storage;
+};
+
+typedef BasicMatrix<DYNAMIC,DYNAMIC> Matrix;
+
+//Inverts the square matrix whose elements start at the first argument, with the dimension in
+//the third argument, mod the fourth argument.  The second argument is a matrix of the same size
+//that is used for the right-hand-side of the augmented matrix.  Returns true if the matrix is
+//invertible, in which case the inverse is in the first matrix.
+bool invert(int*,int*,unsigned,unsigned);
+
+//Multiplies the matrix in the first argument, with the dimensions in the fourth and fifth
+//arguments, by the matrix in the second argument, with the dimensions in the fifth and sixth
+//arguments, mod the last argument, and stores the result in the third argument.  The elements
+//must be between 0 and n - 1.
+void multiply(const int*,const int*,int*,unsigned,unsigned,unsigned,unsigned);
 
 //Turns the matrix into its inverse, mod the second argument.
 //Returns true if the matrix is invertible, otherwise false.
-bool invert(Matrix&,unsigned);
+template<unsigned Dimension>
+bool invert(BasicMatrix<Dimension,Dimension>& matrix,unsigned n){
+	assert(matrix.rows() == matrix.columns());
+	BasicMatrix<Dimension,Dimension> rhs(matrix.rows(),matrix.columns());
+	return invert(matrix.data(),rhs.data(),matrix.rows(),n);
+}
 
 //Multiplies the first matrix by the second matrix mod the third argument, and returns resulting matrix.
-Matrix multiply(const Matrix&,const Matrix&,unsigned);
+template<unsigned Rows,unsigned Inner,unsigned Other_Inner,unsigned Columns>
+BasicMatrix<Rows,Columns> multiply(const BasicMatrix<Rows,Inner>& lhs,const BasicMatrix<Other_Inner,Columns>& rhs,
+		unsigned n){
+	static_assert(!Inner || !Other_Inner || Inner == Other_Inner,"The dimensions of the matrices do not match.");
+	assert(lhs.columns() == rhs.rows());
+	BasicMatrix<Rows,Columns> result(lhs.rows(),rhs.columns());
+	multiply(lhs.data(),rhs.data(),result.data(),lhs.rows(),lhs.columns(),rhs.columns(),n);
+	return result;
+}
 
-#endif /* MATRIX_INVERTER_H_ */
+#endif /* MATH_LIB_H */
@@ -0,0 +1,99 @@
+/*
+ * stream.cpp
+ *
+ *      Author: Arthur Laks
+ *  Contains the implementations of functions that encrypt or decrypt a whole file with the hill
+ *  cipher a block at a time, and that read and write key files.
+ */
+
+#include "stream.h"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+using std::vector;
+
+//The number of characters that are read at a time.
+const std::size_t READ_SIZE = 1 << 20;
+//The number of letters that are multiplied by the key at a time, rounded down to a multiple of
+//the size of the key.
+const std::size_t MULTIPLY_SIZE = 1 << 16;
+
+std::size_t transform_stream(std::istream& input,std::ostream& output,const Matrix& key,char first_letter,
+        bool pad,bool both_cases){
+    const unsigned dimension = key.rows();
+    const std::size_t batch_size = MULTIPLY_SIZE / dimension * dimension;
+    vector<char> characters(READ_SIZE);
+    //The letters of the input as numbers between 0 and 25, and the result of multiplying them
+    //by the key, as a matrix with one block in each row.
+    vector<int> letters(batch_size);
+    vector<int> transformed(batch_size);
+    vector<char> output_characters(batch_size);
+    std::size_t num_letters = 0;
+    //Setting the bit that distinguishes lowercase letters turns uppercase ones into lowercase.
+    const char case_bit = both_cases ? 0x20 : 0;
+    const char first_input_letter = both_cases ? 'a' : 'A';
+
+    //Multiplies the complete blocks in letters by the key, writes them, and moves the letters
+    //of the incomplete block, if there is one, to the beginning.
+    auto flush = [&](){
+        std::size_t num_blocks = num_letters / dimension;
+        multiply(letters.data(),key.data(),transformed.data(),num_blocks,dimension,dimension,26);
+        for(std::size_t index = 0;index < num_blocks * dimension;++index){
+            output_characters[index] = static_cast<char>(transformed[index] + first_letter);
+        }
+        output.write(output_characters.data(),num_blocks * dimension);
+        std::copy(letters.begin() + num_blocks * dimension,letters.begin() + num_letters,letters.begin());
+        num_letters -= num_blocks * dimension;
+    };
+
+    while(input){
+        input.read(characters.data(),characters.size());
+        std::size_t length = input.gcount();
+        for(std::size_t index = 0;index < length;){
+            //Filter the characters without branching, by always storing the number and only
+            //counting it if it is a letter.  The piece is short enough that there is room for all
+            //of it, even if it is all letters.
+            std::size_t end = index + std::min(length - index,batch_size - num_letters);
+            for(;index < end;++index){
+                unsigned letter = static_cast<unsigned>((characters[index] | case_bit) - first_input_letter);
+                letters[num_letters] = letter;
+                num_letters += letter < 26;
+            }
+            if(num_letters == batch_size){
+                flush();
+            }
+        }
+    }
+    flush();
+    std::size_t left_over = num_letters;
+    if(left_over && pad){
+        while(num_letters < dimension){
+            letters[num_letters++] = 'Z' - 'A';
+        }
+        flush();
+        return dimension - left_over;
+    }
+    return left_over;
+}
+
+bool read_key(std::istream& stream,Matrix& key){
+    vector<int> numbers;
+    int number;
+    while(stream >> number){
+        if(number < 0 || number > 25){
+            return false;
+        }
+        numbers.push_back(number);
+    }
+    //Anything other than numbers and whitespace is an error.
+    if(!stream.eof()){
+        return false;
+    }
+    unsigned dimension = static_cast<unsigned>(std::sqrt(static_cast<double>(numbers.size())) + 0.5);
+    if(!dimension || dimension * dimension != numbers.size()){
+        return false;
+    }
+    key = Matrix(dimension,dimension);
+    std::copy(numbers.begin(),numbers.end(),key.data());
+    return true;
+}
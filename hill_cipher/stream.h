@@ -0,0 +1,44 @@
+/*
+ * stream.h
+ *
+ *      Author: Arthur Laks
+ *  Contains the declarations of functions that encrypt or decrypt a whole file with the hill
+ *  cipher a block at a time, and that read and write key files.
+ */
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <istream>
+#include <ostream>
+#include <cstddef>
+
+#include "math_lib.h"
+
+//Reads the letters of the input, in either case if the last argument is true and otherwise only
+//uppercase letters, and ignores all other characters.  Each block of as many letters as the key
+//has rows is multiplied by the key mod 26, and the result is written to the output as letters,
+//starting at the fourth argument ('a' or 'A').  The input is read and written in large pieces,
+//so the memory that is used does not depend on its size.  If the letters do not fill the last
+//block, it is padded with 'Z' if the fifth argument is true, and otherwise it is ignored.
+//Returns the number of letters that were added or ignored.
+std::size_t transform_stream(std::istream&,std::ostream&,const Matrix&,char,bool,bool);
+
+//Reads a square key from a text file of numbers between 0 and 25, one row on each line, in the
+//format that hill_cipher writes.  Returns false if the file does not contain a square matrix
+//of such numbers.
+bool read_key(std::istream&,Matrix&);
+
+//Writes a matrix with a tab after each element and a newline after each row, which is also the
+//format of key files.
+template<unsigned Rows,unsigned Columns>
+void write_matrix(std::ostream& stream,const BasicMatrix<Rows,Columns>& matrix){
+    for(unsigned row = 0;row < matrix.rows();++row){
+        for(unsigned column = 0;column < matrix.columns();++column){
+            stream << matrix[row][column] << "\t";
+        }
+        stream << "\n";
+    }
+}
+
+#endif /* STREAM_H */